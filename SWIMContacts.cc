@@ -0,0 +1,307 @@
+/******************************************************************************
+ * SWIMMobility - A SWIM implementation for the INET Framework of the OMNeT++
+ * Simulator.
+ *
+ * Copyright (C) 2016, Sustainable Communication Networks, University of Bremen, Germany
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ *
+ ******************************************************************************/
+
+/**
+ * The C++ implementation file of the SWIM contact generator.
+ *
+ * @author : Anas bin Muslim (anas1@uni-bremen.de)
+ *
+ */
+
+#include <math.h>
+#include <algorithm>
+#include <limits>
+
+#include "inet/mobility/single/SWIMContacts.h"
+
+namespace inet {
+
+SWIMContactGenerator::SWIMContactGenerator(int noOfNodes, double range, double maxAreaX, double maxAreaY, double endTime, double cellSize)
+{
+    this->noOfNodes = noOfNodes;
+    this->range = range;
+    this->endTime = endTime;
+
+    // cells of at least the range, but not many more cells than nodes
+    if(cellSize <= 0.0) {
+        cellSize = std::max(range, sqrt(maxAreaX * maxAreaY / (4.0 * std::max(noOfNodes, 1))));
+    }
+    this->cellSize = std::max(cellSize, 1.0);
+    cellsX = std::max(1, (int) ceil(maxAreaX / this->cellSize));
+    cellsY = std::max(1, (int) ceil(maxAreaY / this->cellSize));
+    neighbourCells = (int) ceil(range / this->cellSize);
+
+    cells.resize(cellsX * cellsY);
+    nodeCells.resize(noOfNodes);
+    current.resize(noOfNodes);
+    active.assign(noOfNodes, false);
+    openContacts.resize(noOfNodes);
+    nodeStamps.assign(noOfNodes, 0);
+    cellStamps.assign(cells.size(), 0);
+    stamp = 0;
+
+    found = 0;
+    safeTime = 0.0;
+}
+
+int SWIMContactGenerator::cellOf(double position, int noOfCells) const
+{
+    int cell = (int) floor(position / cellSize);
+    return std::min(std::max(cell, 0), noOfCells - 1);
+}
+
+void SWIMContactGenerator::findCells(const Coord &from, const Coord &to, std::vector<int> &cellList)
+{
+    int x = cellOf(from.x, cellsX);
+    int y = cellOf(from.y, cellsY);
+    int lastX = cellOf(to.x, cellsX);
+    int lastY = cellOf(to.y, cellsY);
+
+    cellList.clear();
+    cellList.push_back(y * cellsX + x);
+
+    // walk along the segment from cell to cell, crossing into the
+    // next cell in x or y, whichever border the segment meets first
+    double deltaX = to.x - from.x;
+    double deltaY = to.y - from.y;
+    int stepX = (lastX > x ? 1 : -1);
+    int stepY = (lastY > y ? 1 : -1);
+    double nextX = (deltaX != 0.0 ? ((stepX > 0 ? (x + 1) * cellSize : x * cellSize) - from.x) / deltaX : 0.0);
+    double nextY = (deltaY != 0.0 ? ((stepY > 0 ? (y + 1) * cellSize : y * cellSize) - from.y) / deltaY : 0.0);
+    double stepTimeX = (deltaX != 0.0 ? cellSize / fabs(deltaX) : 0.0);
+    double stepTimeY = (deltaY != 0.0 ? cellSize / fabs(deltaY) : 0.0);
+
+    while(x != lastX || y != lastY) {
+        if(y == lastY || (x != lastX && nextX < nextY)) {
+            x += stepX;
+            nextX += stepTimeX;
+        } else {
+            y += stepY;
+            nextY += stepTimeY;
+        }
+        cellList.push_back(y * cellsX + x);
+    }
+}
+
+void SWIMContactGenerator::findCandidates(int node)
+{
+    candidates.clear();
+    stamp++;
+    nodeStamps[node] = stamp;
+
+    // the nodes in contact are checked in any case
+    for(const openContact &contact : openContacts[node]) {
+        nodeStamps[contact.node] = stamp;
+        candidates.push_back(contact.node);
+    }
+
+    // and every node listed within range of a cell of the segment
+    for(int cell : nodeCells[node]) {
+        int cellX = cell % cellsX;
+        int cellY = cell / cellsX;
+        for(int y = std::max(cellY - neighbourCells, 0); y <= std::min(cellY + neighbourCells, cellsY - 1); y++) {
+            for(int x = std::max(cellX - neighbourCells, 0); x <= std::min(cellX + neighbourCells, cellsX - 1); x++) {
+                int near = y * cellsX + x;
+                if(cellStamps[near] == stamp) {
+                    continue;
+                }
+                cellStamps[near] = stamp;
+                for(int other : cells[near]) {
+                    if(nodeStamps[other] != stamp) {
+                        nodeStamps[other] = stamp;
+                        candidates.push_back(other);
+                    }
+                }
+            }
+        }
+    }
+}
+
+Coord SWIMContactGenerator::positionAt(int node, double time) const
+{
+    const swimSegment &segment = current[node];
+    if(segment.endTime <= segment.startTime) {
+        return segment.target;
+    }
+    return segment.start + (segment.target - segment.start) * ((time - segment.startTime) / (segment.endTime - segment.startTime));
+}
+
+void SWIMContactGenerator::checkPair(int nodeA, int nodeB, double from)
+{
+    const swimSegment &segmentA = current[nodeA];
+    const swimSegment &segmentB = current[nodeB];
+    double to = std::min(std::min(segmentA.endTime, segmentB.endTime), endTime);
+    openContact *contact = findOpenContact(nodeA, nodeB);
+
+    // segments of no time are checked with the segment that follows
+    if(to <= from) {
+        return;
+    }
+    double duration = to - from;
+
+    // relative position and speed of the nodes, where the distance
+    // |position + speed * t| is within range between the two roots
+    Coord position = positionAt(nodeB, from) - positionAt(nodeA, from);
+    Coord speed;
+    if(segmentB.endTime > segmentB.startTime) {
+        speed = speed + (segmentB.target - segmentB.start) / (segmentB.endTime - segmentB.startTime);
+    }
+    if(segmentA.endTime > segmentA.startTime) {
+        speed = speed - (segmentA.target - segmentA.start) / (segmentA.endTime - segmentA.startTime);
+    }
+    double a = speed.x * speed.x + speed.y * speed.y + speed.z * speed.z;
+    double b = 2.0 * (position.x * speed.x + position.y * speed.y + position.z * speed.z);
+    double c = position.x * position.x + position.y * position.y + position.z * position.z - range * range;
+
+    // a contact that is open was in range where the last check ended
+    if(contact != nullptr && c <= range * range * 1e-9) {
+        c = std::min(c, 0.0);
+    }
+
+    bool inRange = false;
+    double enter = 0.0;
+    double leave = duration;
+    if(a == 0.0) {
+        inRange = (c <= 0.0);
+    } else {
+        double discriminant = b * b - 4.0 * a * c;
+        if(discriminant >= 0.0) {
+            double root = sqrt(discriminant);
+            enter = std::max((-b - root) / (2.0 * a), 0.0);
+            leave = std::min((-b + root) / (2.0 * a), duration);
+            inRange = (c <= 0.0 || (enter <= leave && enter < duration));
+            if(c <= 0.0) {
+                enter = 0.0;
+            }
+        }
+    }
+
+    // an open contact ends, if the nodes are not in range at the start
+    if(contact != nullptr && (!inRange || enter > 0.0)) {
+        closePair(nodeA, nodeB, from);
+        contact = nullptr;
+    }
+    if(!inRange || (contact == nullptr && leave <= enter)) {
+        return;
+    }
+
+    if(contact == nullptr) {
+        openPair(nodeA, nodeB, from + enter);
+    }
+    if(leave < duration) {
+        closePair(nodeA, nodeB, from + leave);
+    }
+}
+
+SWIMContactGenerator::openContact *SWIMContactGenerator::findOpenContact(int nodeA, int nodeB)
+{
+    for(openContact &contact : openContacts[nodeA]) {
+        if(contact.node == nodeB) {
+            return &contact;
+        }
+    }
+    return nullptr;
+}
+
+void SWIMContactGenerator::openPair(int nodeA, int nodeB, double time)
+{
+    openContacts[nodeA].push_back(openContact{nodeB, time});
+    openContacts[nodeB].push_back(openContact{nodeA, time});
+    addEvent(nodeA, nodeB, time, true);
+}
+
+void SWIMContactGenerator::closePair(int nodeA, int nodeB, double time)
+{
+    for(int side = 0; side < 2; side++) {
+        std::vector<openContact> &list = openContacts[side == 0 ? nodeA : nodeB];
+        int other = (side == 0 ? nodeB : nodeA);
+        for(size_t i = 0; i < list.size(); i++) {
+            if(list[i].node == other) {
+                list[i] = list.back();
+                list.pop_back();
+                break;
+            }
+        }
+    }
+    addEvent(nodeA, nodeB, time, false);
+}
+
+void SWIMContactGenerator::addEvent(int nodeA, int nodeB, double time, bool up)
+{
+    pendingEvent pending;
+    pending.event.time = time;
+    pending.event.nodeA = std::min(nodeA, nodeB);
+    pending.event.nodeB = std::max(nodeA, nodeB);
+    pending.event.up = up;
+    pending.order = found++;
+    events.push(pending);
+}
+
+void SWIMContactGenerator::addSegment(const swimSegment &segment)
+{
+    int node = segment.node;
+
+    // no event found later can be before the start of this segment
+    safeTime = segment.startTime;
+
+    // list the node in the cells of its new segment
+    for(int cell : nodeCells[node]) {
+        std::vector<int> &list = cells[cell];
+        list.erase(std::find(list.begin(), list.end(), node));
+    }
+    findCells(segment.start, segment.target, nodeCells[node]);
+    for(int cell : nodeCells[node]) {
+        cells[cell].push_back(node);
+    }
+    current[node] = segment;
+    active[node] = true;
+
+    // check it with the nodes that may come within range
+    findCandidates(node);
+    for(int other : candidates) {
+        if(active[other]) {
+            checkPair(node, other, segment.startTime);
+        }
+    }
+}
+
+void SWIMContactGenerator::finish()
+{
+    for(int i = 0; i < noOfNodes; i++) {
+        while(!openContacts[i].empty()) {
+            closePair(i, openContacts[i].back().node, endTime);
+        }
+    }
+    safeTime = std::numeric_limits<double>::infinity();
+}
+
+bool SWIMContactGenerator::nextEvent(swimContactEvent &event)
+{
+    if(events.empty() || events.top().event.time > safeTime) {
+        return false;
+    }
+
+    event = events.top().event;
+    events.pop();
+    return true;
+}
+
+}//namespace inet
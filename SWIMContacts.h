@@ -0,0 +1,140 @@
+/******************************************************************************
+ * SWIMMobility - A SWIM implementation for the INET Framework of the OMNeT++
+ * Simulator.
+ *
+ * Copyright (C) 2016, Sustainable Communication Networks, University of Bremen, Germany
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ *
+ ******************************************************************************/
+
+/**
+* The C++ include file of the SWIM contact generator. It takes the time
+* ordered segments of SWIMTraceGenerator and computes, for every pair of
+* nodes whose segments overlap in time, when they come within range of
+* each other and when they leave it again (nodes move in straight lines
+* at a constant speed, so this is a quadratic equation per segment pair).
+* Only the nodes found near a segment in a grid over the area are checked.
+* The contacts are handed out as a time ordered list of up and down
+* events.
+*
+* @author : Anas bin Muslim (anas1@uni-bremen.de)
+*
+*/
+
+#ifndef __INET_SWIMCONTACTS_H
+#define __INET_SWIMCONTACTS_H
+
+#include <stdint.h>
+#include <queue>
+#include <vector>
+
+#include "inet/mobility/single/SWIMTraceGenerator.h"
+
+namespace inet {
+
+// start (up) or end (down) of a contact between two nodes
+struct swimContactEvent {
+    double time;
+    int nodeA;
+    int nodeB;
+    bool up;
+};
+
+class INET_API SWIMContactGenerator
+{
+protected:
+    struct pendingEvent {
+        swimContactEvent event;
+        uint64_t order;
+
+        // earliest first and, at the same time, in the order found
+        bool operator<(const pendingEvent &other) const {
+            return event.time > other.event.time || (event.time == other.event.time && order > other.order);
+        }
+    };
+
+    // a node in contact with another one since the given time
+    struct openContact {
+        int node;
+        double startTime;
+    };
+
+    int noOfNodes;
+    double range;
+    double endTime;
+
+    // grid over the area, where every node is listed in the cells its
+    // current segment passes through
+    double cellSize;
+    int cellsX;
+    int cellsY;
+    int neighbourCells;
+    std::vector<std::vector<int>> cells;
+    std::vector<std::vector<int>> nodeCells;
+
+    // current segment and open contacts of every node
+    std::vector<swimSegment> current;
+    std::vector<bool> active;
+    std::vector<std::vector<openContact>> openContacts;
+
+    // stamps to check every node and cell only once per segment
+    std::vector<uint64_t> nodeStamps;
+    std::vector<uint64_t> cellStamps;
+    uint64_t stamp;
+    std::vector<int> candidates;
+    std::vector<int> segmentCells;
+
+    // found events, which are final once no later segment can come before them
+    std::priority_queue<pendingEvent> events;
+    uint64_t found;
+    double safeTime;
+
+protected:
+    int cellOf(double position, int noOfCells) const;
+
+    /** Lists the cells a segment passes through **/
+    virtual void findCells(const Coord &from, const Coord &to, std::vector<int> &cellList);
+
+    /** Finds the nodes listed near the cells of a segment **/
+    virtual void findCandidates(int node);
+
+    /** Computes the contacts of a pair of nodes from the given time to the end of the first of their segments **/
+    virtual void checkPair(int nodeA, int nodeB, double from);
+
+    /** Position of a node at a time within its current segment **/
+    Coord positionAt(int node, double time) const;
+
+    openContact *findOpenContact(int nodeA, int nodeB);
+    void openPair(int nodeA, int nodeB, double time);
+    void closePair(int nodeA, int nodeB, double time);
+    void addEvent(int nodeA, int nodeB, double time, bool up);
+
+public:
+    /** Constructor, for contacts within range up to endTime (cellSize 0 picks a size) **/
+    SWIMContactGenerator(int noOfNodes, double range, double maxAreaX, double maxAreaY, double endTime, double cellSize = 0.0);
+
+    /** Adds the next segment of a node (segments must come in the order of their start times) **/
+    virtual void addSegment(const swimSegment &segment);
+
+    /** Closes the contacts still open at the end time, after the last segment **/
+    virtual void finish();
+
+    /** Returns the next event, once no later segment can change it **/
+    virtual bool nextEvent(swimContactEvent &event);
+};
+
+}//namespace inet
+
+#endif
@@ -0,0 +1,75 @@
+/******************************************************************************
+ * SWIMMobility - A SWIM implementation for the INET Framework of the OMNeT++
+ * Simulator.
+ *
+ * Copyright (C) 2016, Sustainable Communication Networks, University of Bremen, Germany
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ *
+ ******************************************************************************/
+
+/**
+* The definitions used by the SWIM model code that does not depend on
+* OMNeT++. Inside INET, they come from the INET Framework. When built
+* headless (SWIM_HEADLESS defined), e.g., for the trace generator in the
+* tools folder, a minimal Coord is provided instead.
+*
+* @author : Anas bin Muslim (anas1@uni-bremen.de)
+*
+*/
+
+#ifndef __INET_SWIMDEFS_H
+#define __INET_SWIMDEFS_H
+
+#ifndef SWIM_HEADLESS
+
+#include "inet/common/INETDefs.h"
+#include "inet/common/geometry/common/Coord.h"
+
+#else
+
+#include <math.h>
+
+#define INET_API
+
+namespace inet {
+
+class Coord
+{
+public:
+    double x;
+    double y;
+    double z;
+
+public:
+    Coord() : x(0.0), y(0.0), z(0.0) {}
+    Coord(double x, double y, double z = 0.0) : x(x), y(y), z(z) {}
+
+    Coord operator+(const Coord &a) const { return Coord(x + a.x, y + a.y, z + a.z); }
+    Coord operator-(const Coord &a) const { return Coord(x - a.x, y - a.y, z - a.z); }
+    Coord operator*(double f) const { return Coord(x * f, y * f, z * f); }
+    Coord operator/(double f) const { return Coord(x / f, y / f, z / f); }
+
+    bool operator==(const Coord &a) const { return x == a.x && y == a.y && z == a.z; }
+    bool operator!=(const Coord &a) const { return !(*this == a); }
+
+    double length() const { return sqrt(x * x + y * y + z * z); }
+    double distance(const Coord &a) const { return (*this - a).length(); }
+};
+
+}//namespace inet
+
+#endif
+
+#endif
@@ -0,0 +1,354 @@
+/******************************************************************************
+ * SWIMMobility - A SWIM implementation for the INET Framework of the OMNeT++
+ * Simulator.
+ *
+ * Copyright (C) 2016, Sustainable Communication Networks, University of Bremen, Germany
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ *
+ ******************************************************************************/
+
+/**
+ * The C++ implementation file of the SWIM kernels.
+ *
+ * @author : Anas bin Muslim (anas1@uni-bremen.de)
+ *
+ */
+
+#include <math.h>
+
+#include "inet/mobility/single/SWIMKernels.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SWIM_KERNELS_AVX2
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define SWIM_KERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+namespace inet {
+
+// the scalar kernel also computes the elements left over by the vector kernels
+
+template<int dims>
+static void distancesScalar(const float *x, const float *y, const float *z, int from, int count,
+        double positionX, double positionY, double positionZ, double *distances)
+{
+    for(int i = from; i < count; i++) {
+        distances[i] = swimLocationDistance<dims>(x, y, z, i, positionX, positionY, positionZ);
+    }
+}
+
+static void popularCountsScalar(const double *distances, int from, int count, double alpha, double maxWeight,
+        double popularWeight, double *distTerms, int *popularFrom)
+{
+    for(int i = from; i < count; i++) {
+        distTerms[i] = alpha * distances[i];
+        popularFrom[i] = swimPopularCount(distTerms[i], alpha, maxWeight, popularWeight);
+    }
+}
+
+static void discOffsetsScalar(const double *u, const double *v, int from, int count, double radius, double *x, double *y)
+{
+    for(int i = from; i < count; i++) {
+        swimDiscOffset(u[i], v[i], radius, x[i], y[i]);
+    }
+}
+
+#if defined(SWIM_KERNELS_AVX2) || defined(SWIM_KERNELS_NEON)
+// the Taylor coefficients of swimDiscOffset(), from the lowest order
+static const double sinCoefficients[8] = {-1.0 / 6, 1.0 / 120, -1.0 / 5040, 1.0 / 362880,
+        -1.0 / 39916800, 1.0 / 6227020800, -1.0 / 1307674368000, 1.0 / 355687428096000};
+static const double cosCoefficients[8] = {-1.0 / 2, 1.0 / 24, -1.0 / 720, 1.0 / 40320, -1.0 / 3628800,
+        1.0 / 479001600, -1.0 / 87178291200, 1.0 / 20922789888000};
+#endif
+
+
+#if defined(SWIM_KERNELS_AVX2)
+
+template<int dims>
+__attribute__((target("avx2")))
+static void distancesAvx2(const float *x, const float *y, const float *z, int count,
+        double positionX, double positionY, double positionZ, double *distances)
+{
+    __m256d px = _mm256_set1_pd(positionX);
+    __m256d py = _mm256_set1_pd(positionY);
+    __m256d pz = _mm256_set1_pd(positionZ);
+    int i = 0;
+
+    for(; i + 4 <= count; i += 4) {
+        __m256d dx = _mm256_sub_pd(_mm256_cvtps_pd(_mm_loadu_ps(x + i)), px);
+        __m256d dy = _mm256_sub_pd(_mm256_cvtps_pd(_mm_loadu_ps(y + i)), py);
+        __m256d sum = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+        if(dims == 3) {
+            __m256d dz = _mm256_sub_pd(_mm256_cvtps_pd(_mm_loadu_ps(z + i)), pz);
+            sum = _mm256_add_pd(sum, _mm256_mul_pd(dz, dz));
+        }
+        _mm256_storeu_pd(distances + i, _mm256_sqrt_pd(sum));
+    }
+    distancesScalar<dims>(x, y, z, i, count, positionX, positionY, positionZ, distances);
+}
+
+// the estimate of swimPopularCount() is taken when the weights show it
+// is the first popular count, the other lanes go through the scalar one
+
+__attribute__((target("avx2")))
+static void popularCountsAvx2(const double *distances, int count, double alpha, double maxWeight,
+        double popularWeight, double *distTerms, int *popularFrom)
+{
+    __m256d a = _mm256_set1_pd(alpha);
+    __m256d rest = _mm256_set1_pd(1.0 - alpha);
+    __m256d max = _mm256_set1_pd(maxWeight);
+    __m256d popular = _mm256_set1_pd(popularWeight);
+    __m256d needed = _mm256_set1_pd(popularWeight * maxWeight);
+    __m256d one = _mm256_set1_pd(1.0);
+    __m256d last = _mm256_set1_pd((double) INT32_MAX);
+    int i = 0;
+
+    for(; i + 4 <= count; i += 4) {
+        __m256d distTerm = _mm256_mul_pd(a, _mm256_loadu_pd(distances + i));
+        __m256d estimate = _mm256_ceil_pd(_mm256_div_pd(_mm256_sub_pd(needed, distTerm), rest));
+        __m256d seen = _mm256_max_pd(_mm256_min_pd(estimate, last), one);
+        __m256d weight = _mm256_div_pd(_mm256_add_pd(distTerm, _mm256_mul_pd(rest, seen)), max);
+        __m256d below = _mm256_div_pd(_mm256_add_pd(distTerm, _mm256_mul_pd(rest, _mm256_sub_pd(seen, one))), max);
+        int first = _mm256_movemask_pd(_mm256_andnot_pd(_mm256_cmp_pd(below, popular, _CMP_GT_OQ),
+                _mm256_cmp_pd(weight, popular, _CMP_GT_OQ)));
+
+        _mm256_storeu_pd(distTerms + i, distTerm);
+        _mm_storeu_si128((__m128i *) (popularFrom + i), _mm256_cvttpd_epi32(seen));
+        for(int j = 0; j < 4; j++) {
+            if(!(first & (1 << j))) {
+                popularFrom[i + j] = swimPopularCount(distTerms[i + j], alpha, maxWeight, popularWeight);
+            }
+        }
+    }
+    popularCountsScalar(distances, i, count, alpha, maxWeight, popularWeight, distTerms, popularFrom);
+}
+
+// the same steps as swimDiscOffset(), where the rotation by the quarters
+// selects and flips the signs of the lanes instead of branching
+
+__attribute__((target("avx2")))
+static __m256d polynomialAvx2(__m256d r2, const double *coefficients, int count)
+{
+    __m256d sum = _mm256_set1_pd(coefficients[count - 1]);
+    for(int i = count - 2; i >= 0; i--) {
+        sum = _mm256_add_pd(_mm256_set1_pd(coefficients[i]), _mm256_mul_pd(r2, sum));
+    }
+    return sum;
+}
+
+__attribute__((target("avx2")))
+static void discOffsetsAvx2(const double *u, const double *v, int count, double radius, double *x, double *y)
+{
+    __m256d four = _mm256_set1_pd(4.0);
+    __m256d half = _mm256_set1_pd(0.5);
+    __m256d quarter = _mm256_set1_pd(1.5707963267948966);
+    __m256d one = _mm256_set1_pd(1.0);
+    __m256d rad = _mm256_set1_pd(radius);
+    __m256i one64 = _mm256_set1_epi64x(1);
+    __m256i two64 = _mm256_set1_epi64x(2);
+    int i = 0;
+
+    for(; i + 4 <= count; i += 4) {
+        __m256d quarters = _mm256_mul_pd(four, _mm256_loadu_pd(v + i));
+        __m256d nearest = _mm256_floor_pd(_mm256_add_pd(quarters, half));
+        __m256d r = _mm256_mul_pd(_mm256_sub_pd(quarters, nearest), quarter);
+        __m256d r2 = _mm256_mul_pd(r, r);
+        __m256d s = _mm256_add_pd(r, _mm256_mul_pd(_mm256_mul_pd(r, r2), polynomialAvx2(r2, sinCoefficients, 8)));
+        __m256d c = _mm256_add_pd(one, _mm256_mul_pd(r2, polynomialAvx2(r2, cosCoefficients, 8)));
+
+        __m256i n = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(nearest));
+        __m256d odd = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(n, one64), one64));
+        __m256d cosSign = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_and_si256(_mm256_add_epi64(n, one64), two64), 62));
+        __m256d sinSign = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_and_si256(n, two64), 62));
+        __m256d cosT = _mm256_xor_pd(_mm256_blendv_pd(c, s, odd), cosSign);
+        __m256d sinT = _mm256_xor_pd(_mm256_blendv_pd(s, c, odd), sinSign);
+
+        __m256d w = _mm256_mul_pd(rad, _mm256_sqrt_pd(_mm256_loadu_pd(u + i)));
+        _mm256_storeu_pd(x + i, _mm256_mul_pd(w, cosT));
+        _mm256_storeu_pd(y + i, _mm256_mul_pd(w, sinT));
+    }
+    discOffsetsScalar(u, v, i, count, radius, x, y);
+}
+
+static bool hasAvx2()
+{
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+}
+
+#elif defined(SWIM_KERNELS_NEON)
+
+template<int dims>
+static void distancesNeon(const float *x, const float *y, const float *z, int count,
+        double positionX, double positionY, double positionZ, double *distances)
+{
+    float64x2_t px = vdupq_n_f64(positionX);
+    float64x2_t py = vdupq_n_f64(positionY);
+    float64x2_t pz = vdupq_n_f64(positionZ);
+    int i = 0;
+
+    for(; i + 2 <= count; i += 2) {
+        float64x2_t dx = vsubq_f64(vcvt_f64_f32(vld1_f32(x + i)), px);
+        float64x2_t dy = vsubq_f64(vcvt_f64_f32(vld1_f32(y + i)), py);
+        float64x2_t sum = vaddq_f64(vmulq_f64(dx, dx), vmulq_f64(dy, dy));
+        if(dims == 3) {
+            float64x2_t dz = vsubq_f64(vcvt_f64_f32(vld1_f32(z + i)), pz);
+            sum = vaddq_f64(sum, vmulq_f64(dz, dz));
+        }
+        vst1q_f64(distances + i, vsqrtq_f64(sum));
+    }
+    distancesScalar<dims>(x, y, z, i, count, positionX, positionY, positionZ, distances);
+}
+
+static void popularCountsNeon(const double *distances, int count, double alpha, double maxWeight,
+        double popularWeight, double *distTerms, int *popularFrom)
+{
+    float64x2_t a = vdupq_n_f64(alpha);
+    float64x2_t rest = vdupq_n_f64(1.0 - alpha);
+    float64x2_t max = vdupq_n_f64(maxWeight);
+    float64x2_t popular = vdupq_n_f64(popularWeight);
+    float64x2_t needed = vdupq_n_f64(popularWeight * maxWeight);
+    float64x2_t one = vdupq_n_f64(1.0);
+    float64x2_t last = vdupq_n_f64((double) INT32_MAX);
+    int i = 0;
+
+    for(; i + 2 <= count; i += 2) {
+        float64x2_t distTerm = vmulq_f64(a, vld1q_f64(distances + i));
+        float64x2_t estimate = vrndpq_f64(vdivq_f64(vsubq_f64(needed, distTerm), rest));
+        float64x2_t seen = vmaxnmq_f64(vminnmq_f64(estimate, last), one);
+        float64x2_t weight = vdivq_f64(vaddq_f64(distTerm, vmulq_f64(rest, seen)), max);
+        float64x2_t below = vdivq_f64(vaddq_f64(distTerm, vmulq_f64(rest, vsubq_f64(seen, one))), max);
+        uint64x2_t first = vbicq_u64(vcgtq_f64(weight, popular), vcgtq_f64(below, popular));
+
+        vst1q_f64(distTerms + i, distTerm);
+        vst1_s32(popularFrom + i, vmovn_s64(vcvtq_s64_f64(seen)));
+        for(int j = 0; j < 2; j++) {
+            if(!(j == 0 ? vgetq_lane_u64(first, 0) : vgetq_lane_u64(first, 1))) {
+                popularFrom[i + j] = swimPopularCount(distTerms[i + j], alpha, maxWeight, popularWeight);
+            }
+        }
+    }
+    popularCountsScalar(distances, i, count, alpha, maxWeight, popularWeight, distTerms, popularFrom);
+}
+
+static float64x2_t polynomialNeon(float64x2_t r2, const double *coefficients, int count)
+{
+    float64x2_t sum = vdupq_n_f64(coefficients[count - 1]);
+    for(int i = count - 2; i >= 0; i--) {
+        sum = vaddq_f64(vdupq_n_f64(coefficients[i]), vmulq_f64(r2, sum));
+    }
+    return sum;
+}
+
+static void discOffsetsNeon(const double *u, const double *v, int count, double radius, double *x, double *y)
+{
+    float64x2_t four = vdupq_n_f64(4.0);
+    float64x2_t half = vdupq_n_f64(0.5);
+    float64x2_t quarter = vdupq_n_f64(1.5707963267948966);
+    float64x2_t one = vdupq_n_f64(1.0);
+    float64x2_t rad = vdupq_n_f64(radius);
+    int64x2_t one64 = vdupq_n_s64(1);
+    int64x2_t two64 = vdupq_n_s64(2);
+    int i = 0;
+
+    for(; i + 2 <= count; i += 2) {
+        float64x2_t quarters = vmulq_f64(four, vld1q_f64(v + i));
+        float64x2_t nearest = vrndmq_f64(vaddq_f64(quarters, half));
+        float64x2_t r = vmulq_f64(vsubq_f64(quarters, nearest), quarter);
+        float64x2_t r2 = vmulq_f64(r, r);
+        float64x2_t s = vaddq_f64(r, vmulq_f64(vmulq_f64(r, r2), polynomialNeon(r2, sinCoefficients, 8)));
+        float64x2_t c = vaddq_f64(one, vmulq_f64(r2, polynomialNeon(r2, cosCoefficients, 8)));
+
+        int64x2_t n = vcvtq_s64_f64(nearest);
+        uint64x2_t odd = vceqq_s64(vandq_s64(n, one64), one64);
+        uint64x2_t cosSign = vreinterpretq_u64_s64(vshlq_n_s64(vandq_s64(vaddq_s64(n, one64), two64), 62));
+        uint64x2_t sinSign = vreinterpretq_u64_s64(vshlq_n_s64(vandq_s64(n, two64), 62));
+        float64x2_t cosT = vreinterpretq_f64_u64(veorq_u64(vreinterpretq_u64_f64(vbslq_f64(odd, s, c)), cosSign));
+        float64x2_t sinT = vreinterpretq_f64_u64(veorq_u64(vreinterpretq_u64_f64(vbslq_f64(odd, c, s)), sinSign));
+
+        float64x2_t w = vmulq_f64(rad, vsqrtq_f64(vld1q_f64(u + i)));
+        vst1q_f64(x + i, vmulq_f64(w, cosT));
+        vst1q_f64(y + i, vmulq_f64(w, sinT));
+    }
+    discOffsetsScalar(u, v, i, count, radius, x, y);
+}
+
+#endif
+
+template<int dims>
+void swimLocationDistances(const float *x, const float *y, const float *z, int count,
+        double positionX, double positionY, double positionZ, double *distances)
+{
+#if defined(SWIM_KERNELS_AVX2)
+    if(hasAvx2()) {
+        distancesAvx2<dims>(x, y, z, count, positionX, positionY, positionZ, distances);
+        return;
+    }
+#elif defined(SWIM_KERNELS_NEON)
+    distancesNeon<dims>(x, y, z, count, positionX, positionY, positionZ, distances);
+    return;
+#endif
+    distancesScalar<dims>(x, y, z, 0, count, positionX, positionY, positionZ, distances);
+}
+
+template void swimLocationDistances<2>(const float *x, const float *y, const float *z, int count,
+        double positionX, double positionY, double positionZ, double *distances);
+template void swimLocationDistances<3>(const float *x, const float *y, const float *z, int count,
+        double positionX, double positionY, double positionZ, double *distances);
+
+void swimPopularCounts(const double *distances, int count, double alpha, double maxWeight, double popularWeight,
+        double *distTerms, int *popularFrom)
+{
+#if defined(SWIM_KERNELS_AVX2)
+    if(hasAvx2()) {
+        popularCountsAvx2(distances, count, alpha, maxWeight, popularWeight, distTerms, popularFrom);
+        return;
+    }
+#elif defined(SWIM_KERNELS_NEON)
+    popularCountsNeon(distances, count, alpha, maxWeight, popularWeight, distTerms, popularFrom);
+    return;
+#endif
+    popularCountsScalar(distances, 0, count, alpha, maxWeight, popularWeight, distTerms, popularFrom);
+}
+
+void swimDiscOffsets(const double *u, const double *v, int count, double radius, double *x, double *y)
+{
+#if defined(SWIM_KERNELS_AVX2)
+    if(hasAvx2()) {
+        discOffsetsAvx2(u, v, count, radius, x, y);
+        return;
+    }
+#elif defined(SWIM_KERNELS_NEON)
+    discOffsetsNeon(u, v, count, radius, x, y);
+    return;
+#endif
+    discOffsetsScalar(u, v, 0, count, radius, x, y);
+}
+
+
+const char *swimKernelName()
+{
+#if defined(SWIM_KERNELS_AVX2)
+    return hasAvx2() ? "avx2" : "scalar";
+#elif defined(SWIM_KERNELS_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+}//namespace inet
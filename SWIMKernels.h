@@ -0,0 +1,142 @@
+/******************************************************************************
+ * SWIMMobility - A SWIM implementation for the INET Framework of the OMNeT++
+ * Simulator.
+ *
+ * Copyright (C) 2016, Sustainable Communication Networks, University of Bremen, Germany
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ *
+ ******************************************************************************/
+
+/**
+* The C++ include file of the SWIM kernels, which compute the distances
+* of all the locations at once from the separate x, y and z arrays of
+* the locations. They use AVX2 (x86, when the CPU
+* has it) or NEON (ARM64) and plain C++ otherwise. All of them compute
+* in double precision with the same operations in the same order, so
+* their results are exactly the same. They are instantiated for 2 and 3
+* dimensions, where the 2 dimensional ones use no z coordinates at all.
+* The weight kernels compute the distance terms of the weights and, from
+* the weights themselves, the number of nodes present from which every
+* location is popular.
+* The disc kernels turn blocks of uniform random numbers into positions
+* around a location in the same way.
+*
+* @author : Anas bin Muslim (anas1@uni-bremen.de)
+*
+*/
+
+#ifndef __INET_SWIMKERNELS_H
+#define __INET_SWIMKERNELS_H
+
+#include <math.h>
+#include <stdint.h>
+
+#include "inet/mobility/single/SWIMDefs.h"
+
+namespace inet {
+
+/** Computes the distance of every location to the given position (z is not used, and may be null, in 2 dimensions) **/
+template<int dims>
+INET_API void swimLocationDistances(const float *x, const float *y, const float *z, int count,
+        double positionX, double positionY, double positionZ, double *distances);
+
+typedef void (*swimDistancesKernel)(const float *x, const float *y, const float *z, int count,
+        double positionX, double positionY, double positionZ, double *distances);
+
+/** Computes the distance of one location to the given position, as the kernels do **/
+template<int dims>
+inline double swimLocationDistance(const float *x, const float *y, const float *z, int i,
+        double positionX, double positionY, double positionZ)
+{
+    double dx = x[i] - positionX;
+    double dy = y[i] - positionY;
+    double sum = dx * dx + dy * dy;
+    if(dims == 3) {
+        double dz = z[i] - positionZ;
+        sum += dz * dz;
+    }
+    return sqrt(sum);
+}
+
+/** Computes the distance term (alpha * distance) of the weight of every location and the smallest number of nodes
+    present for which its weight is above popularWeight (INT32_MAX for none) **/
+INET_API void swimPopularCounts(const double *distances, int count, double alpha, double maxWeight, double popularWeight,
+        double *distTerms, int *popularFrom);
+
+/** Computes the number of nodes present from which one location is popular, as the weight kernels do **/
+inline int swimPopularCount(double distTerm, double alpha, double maxWeight, double popularWeight)
+{
+    // the weight grows with the nodes present (also as rounded), so the
+    // count follows from the weight formula up to rounding, which is
+    // settled by the weight itself
+    auto popularAt = [&](int64_t count) { return (distTerm + (1.0 - alpha) * count) / maxWeight > popularWeight; };
+    if(popularAt(0)) {
+        return 0;
+    } else if(!popularAt(INT32_MAX)) {
+        return INT32_MAX;
+    }
+
+    double estimate = ceil((popularWeight * maxWeight - distTerm) / (1.0 - alpha));
+    int64_t count = (int64_t) fmax(1.0, fmin(estimate, (double) INT32_MAX));
+    while(count > 1 && popularAt(count - 1)) {
+        count--;
+    }
+    while(!popularAt(count)) {
+        count++;
+    }
+    return (int) count;
+}
+
+/** Draws a position in a disc of the given radius for each pair of uniform numbers u and v in [0, 1),
+    in polar coordinates (radius * sqrt(u) at an angle of v turns), with a cos and sin of its own **/
+INET_API void swimDiscOffsets(const double *u, const double *v, int count, double radius, double *x, double *y);
+
+/** Draws one position in the disc, as the disc kernels do **/
+inline void swimDiscOffset(double u, double v, double radius, double &x, double &y)
+{
+    // the angle is reduced to [-1/8, 1/8] turns around the nearest
+    // quarter (exactly, as 4 v and its floor are exact), where the
+    // Taylor series of cos and sin are within an ulp or two
+    double quarters = 4.0 * v;
+    double nearest = floor(quarters + 0.5);
+    double r = (quarters - nearest) * 1.5707963267948966;
+    double r2 = r * r;
+    double s = r + r * r2 * (-1.0 / 6 + r2 * (1.0 / 120 + r2 * (-1.0 / 5040 + r2 * (1.0 / 362880
+            + r2 * (-1.0 / 39916800 + r2 * (1.0 / 6227020800 + r2 * (-1.0 / 1307674368000 + r2 * (1.0 / 355687428096000))))))));
+    double c = 1.0 + r2 * (-1.0 / 2 + r2 * (1.0 / 24 + r2 * (-1.0 / 720 + r2 * (1.0 / 40320 + r2 * (-1.0 / 3628800
+            + r2 * (1.0 / 479001600 + r2 * (-1.0 / 87178291200 + r2 * (1.0 / 20922789888000))))))));
+
+    // rotate by the quarters: (c, s), (-s, c), (-c, -s) or (s, -c)
+    int quarter = (int) nearest & 3;
+    double cosT = ((quarter & 1) ? s : c);
+    double sinT = ((quarter & 1) ? c : s);
+    if((quarter + 1) & 2) {
+        cosT = -cosT;
+    }
+    if(quarter & 2) {
+        sinT = -sinT;
+    }
+
+    double w = radius * sqrt(u);
+    x = w * cosT;
+    y = w * sinT;
+}
+
+/** Name of the kernels used (avx2, neon or scalar) **/
+INET_API const char *swimKernelName();
+
+}//namespace inet
+
+#endif
@@ -0,0 +1,396 @@
+/******************************************************************************
+ * SWIMMobility - A SWIM implementation for the INET Framework of the OMNeT++
+ * Simulator.
+ *
+ * Copyright (C) 2016, Sustainable Communication Networks, University of Bremen, Germany
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ *
+ ******************************************************************************/
+
+/**
+ * The C++ implementation file of the SWIM location generator.
+ *
+ * @author : Anas bin Muslim (anas1@uni-bremen.de)
+ *
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "inet/mobility/single/SWIMLocationGenerator.h"
+
+namespace inet {
+
+// candidates per chunk (and random number stream)
+#define LOCATION_CHUNK          4096
+
+// chunks drawn at once at most, and candidates drawn per location at most
+// before the minimum separation is taken to leave no room
+#define MAX_CHUNKS_AT_ONCE      256
+#define MAX_CANDIDATES_PER_LOC  64
+
+#define NO_CELL                 UINT64_MAX
+
+#define TWO_PI                  6.283185307179586
+
+// a number in [0, 1) from 53 random bits
+static inline double uniform01(std::mt19937_64 &rng)
+{
+    return (rng() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// a normally distributed number (Box-Muller)
+static inline double normal01(std::mt19937_64 &rng)
+{
+    double u1 = 1.0 - uniform01(rng);
+    double u2 = uniform01(rng);
+    return sqrt(-2.0 * log(u1)) * cos(TWO_PI * u2);
+}
+
+// the random numbers of a chunk (or of the cluster centres) follow from
+// the seed and the number of the chunk only
+static std::mt19937_64 chunkStream(uint64_t seed, uint64_t chunk)
+{
+    std::seed_seq sequence{(uint32_t) seed, (uint32_t) (seed >> 32), (uint32_t) chunk, (uint32_t) (chunk >> 32)};
+    return std::mt19937_64(sequence);
+}
+
+SWIMLocationGenerator::SWIMLocationGenerator(const swimLayoutParams &params, int noOfLocs, int dimensions,
+        double maxAreaX, double maxAreaY, double maxAreaZ, double border, uint64_t seed)
+    : params(params), noOfLocs(noOfLocs), dimensions(dimensions), border(border), seed(seed)
+{
+    maxArea[0] = maxAreaX;
+    maxArea[1] = maxAreaY;
+    maxArea[2] = maxAreaZ;
+    rows = 0;
+    columns = 0;
+    cellSize = 0.0;
+}
+
+bool SWIMLocationGenerator::parseLayout(const std::string &name, int &layout)
+{
+    if(name == "uniform") {
+        layout = LAYOUT_UNIFORM;
+    } else if(name == "thomas") {
+        layout = LAYOUT_THOMAS;
+    } else if(name == "matern") {
+        layout = LAYOUT_MATERN;
+    } else if(name == "heatmap") {
+        layout = LAYOUT_HEATMAP;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+uint64_t SWIMLocationGenerator::hashFile(const char *fileName)
+{
+    std::ifstream infile(fileName, std::ios::binary);
+    if(!infile.is_open()) {
+        return 0;
+    }
+
+    // FNV-1a over all the bytes
+    uint64_t hash = 14695981039346656037ULL;
+    char buffer[65536];
+    while(infile.read(buffer, sizeof(buffer)) || infile.gcount() > 0) {
+        for(std::streamsize i = 0; i < infile.gcount(); i++) {
+            hash = (hash ^ (unsigned char) buffer[i]) * 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+bool SWIMLocationGenerator::readHeatmap()
+{
+    std::ifstream infile(params.heatmapFile.c_str());
+    std::string line;
+
+    if(!infile.is_open()) {
+        return false;
+    }
+
+    // one row of non-negative weights per line, the first row at y = 0
+    rows = 0;
+    columns = 0;
+    cellSums.clear();
+    double sum = 0.0;
+    while(getline(infile, line)) {
+        std::istringstream values(line);
+        double weight;
+        int count = 0;
+        while(values >> weight) {
+            if(weight < 0.0) {
+                return false;
+            }
+            sum += weight;
+            cellSums.push_back(sum);
+            count++;
+        }
+        if(count == 0) {
+            continue;
+        }
+        if(rows > 0 && count != columns) {
+            return false;
+        }
+        columns = count;
+        rows++;
+    }
+
+    return rows > 0 && sum > 0.0;
+}
+
+void SWIMLocationGenerator::drawChunk(uint64_t chunk, loc *candidates) const
+{
+    std::mt19937_64 rng = chunkStream(seed, chunk);
+    double *position[3];
+    loc candidate;
+
+    position[0] = &candidate.myCoordX;
+    position[1] = &candidate.myCoordY;
+    position[2] = &candidate.myCoordZ;
+
+    for(int i = 0; i < LOCATION_CHUNK; i++) {
+        candidate.myCoordZ = 0.0;
+
+        if(params.layout == LAYOUT_THOMAS || params.layout == LAYOUT_MATERN) {
+
+            // around a random cluster centre, at a normally distributed
+            // offset (Thomas) or anywhere within a disc (Matern)
+            const loc &centre = centres[std::min((int) (uniform01(rng) * centres.size()), (int) centres.size() - 1)];
+            if(params.layout == LAYOUT_THOMAS) {
+                candidate.myCoordX = centre.myCoordX + params.clusterRadius * normal01(rng);
+                candidate.myCoordY = centre.myCoordY + params.clusterRadius * normal01(rng);
+                if(dimensions == 3) {
+                    candidate.myCoordZ = centre.myCoordZ + params.clusterRadius * normal01(rng);
+                }
+            } else {
+                double distance = params.clusterRadius * sqrt(uniform01(rng));
+                double angle = TWO_PI * uniform01(rng);
+                candidate.myCoordX = centre.myCoordX + distance * cos(angle);
+                candidate.myCoordY = centre.myCoordY + distance * sin(angle);
+                if(dimensions == 3) {
+                    candidate.myCoordZ = centre.myCoordZ + params.clusterRadius * (2.0 * uniform01(rng) - 1.0);
+                }
+            }
+
+        } else if(params.layout == LAYOUT_HEATMAP) {
+
+            // in a cell drawn in proportion to its weight, anywhere in it
+            int cell = std::upper_bound(cellSums.begin(), cellSums.end(), uniform01(rng) * cellSums.back()) - cellSums.begin();
+            cell = std::min(cell, rows * columns - 1);
+            double cellWidth = maxArea[0] / columns;
+            double cellHeight = maxArea[1] / rows;
+            candidate.myCoordX = ((cell % columns) + uniform01(rng)) * cellWidth;
+            candidate.myCoordY = ((cell / columns) + uniform01(rng)) * cellHeight;
+            if(dimensions == 3) {
+                candidate.myCoordZ = border + uniform01(rng) * (maxArea[2] - 2.0 * border);
+            }
+
+        } else {
+            for(int d = 0; d < dimensions; d++) {
+                *position[d] = border + uniform01(rng) * (maxArea[d] - 2.0 * border);
+            }
+        }
+
+        // integer coordinates (as for the uniform locations created one
+        // by one), within the borders
+        for(int d = 0; d < dimensions; d++) {
+            double coordinate = (int) *position[d];
+            *position[d] = (coordinate >= border && coordinate <= maxArea[d] - border ? coordinate : NAN);
+        }
+        if(dimensions != 3) {
+            candidate.myCoordZ = 0.0;
+        }
+
+        candidates[i] = candidate;
+    }
+}
+
+void SWIMLocationGenerator::drawChunks(uint64_t firstChunk, int noOfChunks, std::vector<loc> &candidates) const
+{
+    candidates.resize((size_t) noOfChunks * LOCATION_CHUNK);
+
+    int threads = (params.threads > 0 ? params.threads : (int) std::thread::hardware_concurrency());
+    threads = std::min(threads, noOfChunks);
+    if(threads < 2) {
+        for(int c = 0; c < noOfChunks; c++) {
+            drawChunk(firstChunk + c, candidates.data() + (size_t) c * LOCATION_CHUNK);
+        }
+        return;
+    }
+
+    std::atomic<int> nextChunk(0);
+    std::vector<std::thread> workers;
+    for(int t = 0; t < threads; t++) {
+        workers.emplace_back([&]() {
+            for(int c = nextChunk++; c < noOfChunks; c = nextChunk++) {
+                drawChunk(firstChunk + c, candidates.data() + (size_t) c * LOCATION_CHUNK);
+            }
+        });
+    }
+    for(std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+uint64_t SWIMLocationGenerator::cellKey(int64_t cellX, int64_t cellY, int64_t cellZ)
+{
+    return ((uint64_t) (cellX & 0x1fffff) << 42) | ((uint64_t) (cellY & 0x1fffff) << 21) | (uint64_t) (cellZ & 0x1fffff);
+}
+
+// slot of a key in the open addressing table (mixed as in splitmix64)
+static inline size_t cellSlot(uint64_t key, size_t mask)
+{
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+    return (key ^ (key >> 31)) & mask;
+}
+
+bool SWIMLocationGenerator::tooClose(const std::vector<loc> &locs, const loc &candidate) const
+{
+    size_t mask = cellKeys.size() - 1;
+    int64_t cellX = (int64_t) floor(candidate.myCoordX / cellSize);
+    int64_t cellY = (int64_t) floor(candidate.myCoordY / cellSize);
+    int64_t cellZ = (int64_t) floor(candidate.myCoordZ / cellSize);
+    double squaredSeparation = params.minSeparation * params.minSeparation;
+
+    // a cell is at most the separation wide across, so the locations
+    // that may be too close are within two cells in every direction
+    int reachZ = (dimensions == 3 ? 2 : 0);
+    for(int64_t z = cellZ - reachZ; z <= cellZ + reachZ; z++) {
+        for(int64_t y = cellY - 2; y <= cellY + 2; y++) {
+            for(int64_t x = cellX - 2; x <= cellX + 2; x++) {
+                uint64_t key = cellKey(x, y, z);
+
+                // keys of far apart cells may be the same, so all the
+                // locations of a key are checked
+                for(size_t slot = cellSlot(key, mask); cellKeys[slot] != NO_CELL; slot = (slot + 1) & mask) {
+                    if(cellKeys[slot] != key) {
+                        continue;
+                    }
+                    const loc &other = locs[cellLocations[slot]];
+                    double dx = other.myCoordX - candidate.myCoordX;
+                    double dy = other.myCoordY - candidate.myCoordY;
+                    double dz = other.myCoordZ - candidate.myCoordZ;
+                    if(dx * dx + dy * dy + dz * dz < squaredSeparation) {
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+void SWIMLocationGenerator::addToGrid(const loc &location, int index)
+{
+    size_t mask = cellKeys.size() - 1;
+    uint64_t key = cellKey((int64_t) floor(location.myCoordX / cellSize), (int64_t) floor(location.myCoordY / cellSize),
+            (int64_t) floor(location.myCoordZ / cellSize));
+
+    size_t slot = cellSlot(key, mask);
+    while(cellKeys[slot] != NO_CELL) {
+        slot = (slot + 1) & mask;
+    }
+    cellKeys[slot] = key;
+    cellLocations[slot] = index;
+}
+
+bool SWIMLocationGenerator::generate(std::vector<loc> &locs)
+{
+    locs.resize(noOfLocs);
+    if(noOfLocs == 0) {
+        return true;
+    }
+
+    // no locations are created at the borders
+    for(int d = 0; d < dimensions; d++) {
+        if(!(maxArea[d] > 2.0 * border)) {
+            return false;
+        }
+    }
+
+    // the cluster centres come from a stream of their own
+    if(params.layout == LAYOUT_THOMAS || params.layout == LAYOUT_MATERN) {
+        if(params.clusters <= 0) {
+            return false;
+        }
+        std::mt19937_64 rng = chunkStream(seed, UINT64_MAX);
+        centres.resize(params.clusters);
+        for(loc &centre : centres) {
+            centre.myCoordX = border + uniform01(rng) * (maxArea[0] - 2.0 * border);
+            centre.myCoordY = border + uniform01(rng) * (maxArea[1] - 2.0 * border);
+            centre.myCoordZ = (dimensions == 3 ? border + uniform01(rng) * (maxArea[2] - 2.0 * border) : 0.0);
+        }
+    } else if(params.layout == LAYOUT_HEATMAP && !readHeatmap()) {
+        return false;
+    }
+
+    // cells of the separation grid hold at most one location each
+    bool separated = (params.minSeparation > 0.0);
+    if(separated) {
+        size_t size = 1;
+        while(size < 2 * (size_t) noOfLocs) {
+            size *= 2;
+        }
+        cellSize = params.minSeparation / sqrt((double) (dimensions == 3 ? 3 : 2));
+        cellKeys.assign(size, NO_CELL);
+        cellLocations.assign(size, -1);
+    }
+
+    // accept the candidates in the order of the chunks, drawing the
+    // chunks on the threads as many at a time as are needed (without
+    // rejections) for the rest of the locations
+    std::vector<loc> candidates;
+    uint64_t chunk = 0;
+    uint64_t maxChunks = ((uint64_t) noOfLocs * MAX_CANDIDATES_PER_LOC) / LOCATION_CHUNK + 1;
+    int accepted = 0;
+    while(accepted < noOfLocs) {
+        if(chunk >= maxChunks) {
+            return false;
+        }
+        int remaining = noOfLocs - accepted;
+        int noOfChunks = std::min(std::max((remaining + LOCATION_CHUNK - 1) / LOCATION_CHUNK, 1), MAX_CHUNKS_AT_ONCE);
+        drawChunks(chunk, noOfChunks, candidates);
+        chunk += noOfChunks;
+
+        for(const loc &candidate : candidates) {
+            if(isnan(candidate.myCoordX) || isnan(candidate.myCoordY) || isnan(candidate.myCoordZ)) {
+                continue;
+            }
+            if(separated) {
+                if(tooClose(locs, candidate)) {
+                    continue;
+                }
+                addToGrid(candidate, accepted);
+            }
+            locs[accepted] = candidate;
+            if(++accepted == noOfLocs) {
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+}//namespace inet
@@ -0,0 +1,130 @@
+/******************************************************************************
+ * SWIMMobility - A SWIM implementation for the INET Framework of the OMNeT++
+ * Simulator.
+ *
+ * Copyright (C) 2016, Sustainable Communication Networks, University of Bremen, Germany
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ *
+ ******************************************************************************/
+
+
+/**
+* The C++ include file of the SWIM location generator, which creates
+* large numbers of locations spread uniformly, in clusters (a Thomas
+* process with Gaussian clusters or a Matern process with uniform discs
+* around random cluster centres) or after the weights of a heatmap
+* raster, with an optional minimum separation between locations.
+*
+* Candidate locations are drawn in chunks, each from a random number
+* stream of its own (seeded with the seed and the number of the chunk),
+* so the chunks may be drawn on any number of threads. The candidates are
+* then accepted in the order of the chunks, rejecting those too close to
+* an accepted location (found through a hash of the cells of a grid),
+* until there are enough. The locations are the same for any number of
+* threads, and no distributions of the standard library (which differ
+* between implementations) are used.
+*
+* @author : Anas bin Muslim (anas1@uni-bremen.de)
+*
+*/
+
+#ifndef __INET_SWIMLOCATIONGENERATOR_H
+#define __INET_SWIMLOCATIONGENERATOR_H
+
+#include <stdint.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "inet/mobility/single/SWIMLocations.h"
+
+#define LAYOUT_UNIFORM          0
+#define LAYOUT_THOMAS           1
+#define LAYOUT_MATERN           2
+#define LAYOUT_HEATMAP          3
+
+namespace inet {
+
+// how the locations are created (see SWIMMobility.ned)
+struct swimLayoutParams {
+    int layout = LAYOUT_UNIFORM;
+    int clusters = 100;
+    double clusterRadius = 50.0;
+    double minSeparation = 0.0;
+    std::string heatmapFile;
+    int threads = 1;
+};
+
+class INET_API SWIMLocationGenerator
+{
+protected:
+    swimLayoutParams params;
+    int noOfLocs;
+    int dimensions;
+    double maxArea[3];
+    double border;
+    uint64_t seed;
+
+    // the cluster centres, or the running sums of the weights of the
+    // heatmap cells (with the number of rows and columns)
+    std::vector<loc> centres;
+    std::vector<double> cellSums;
+    int rows;
+    int columns;
+
+    // the accepted locations by cell of the separation grid, in an open
+    // addressing table of cell keys and location indices
+    double cellSize;
+    std::vector<uint64_t> cellKeys;
+    std::vector<int> cellLocations;
+
+protected:
+    /** Reads the heatmap raster and sums the weights of its cells **/
+    bool readHeatmap();
+
+    /** Draws the candidates of one chunk (NaN x for candidates outside the area) **/
+    void drawChunk(uint64_t chunk, loc *candidates) const;
+
+    /** Draws the chunks from the given one on, on the threads **/
+    void drawChunks(uint64_t firstChunk, int noOfChunks, std::vector<loc> &candidates) const;
+
+    /** Key of the cell of the separation grid at the given cell coordinates **/
+    static uint64_t cellKey(int64_t cellX, int64_t cellY, int64_t cellZ);
+
+    /** Whether an accepted location is closer than the minimum separation **/
+    bool tooClose(const std::vector<loc> &locs, const loc &candidate) const;
+
+    /** Adds an accepted location to the separation grid **/
+    void addToGrid(const loc &location, int index);
+
+public:
+    /** Constructor, for the given locations, area (between border and the maxima) and seed **/
+    SWIMLocationGenerator(const swimLayoutParams &params, int noOfLocs, int dimensions,
+            double maxAreaX, double maxAreaY, double maxAreaZ, double border, uint64_t seed);
+
+    /** Creates the locations (false if the area is too small, the heatmap cannot be read
+        or the minimum separation leaves no room for all the locations) **/
+    bool generate(std::vector<loc> &locs);
+
+    /** Finds the layout of the given name (uniform, thomas, matern or heatmap) **/
+    static bool parseLayout(const std::string &name, int &layout);
+
+    /** Fingerprint of the contents of a file (0 if it cannot be read) **/
+    static uint64_t hashFile(const char *fileName);
+};
+
+}//namespace inet
+
+#endif
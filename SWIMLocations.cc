@@ -0,0 +1,262 @@
+/******************************************************************************
+ * SWIMMobility - A SWIM implementation for the INET Framework of the OMNeT++
+ * Simulator.
+ *
+ * Copyright (C) 2016, Sustainable Communication Networks, University of Bremen, Germany
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ *
+ ******************************************************************************/
+
+/**
+ * The C++ implementation file of the locations file used by the SWIM
+ * mobility model.
+ *
+ * @author : Anas bin Muslim (anas1@uni-bremen.de)
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#else
+#include <process.h>
+#define getpid _getpid
+#endif
+
+#include "inet/mobility/single/SWIMLocations.h"
+
+namespace inet {
+
+SWIMLocationsFile::SWIMLocationsFile()
+{
+    memset(&header, 0, sizeof(header));
+    locations = nullptr;
+    mapping = nullptr;
+    mappingSize = 0;
+}
+
+SWIMLocationsFile::~SWIMLocationsFile()
+{
+    unmap();
+}
+
+void SWIMLocationsFile::initHeader(locHeader &header)
+{
+    memset(&header, 0, sizeof(header));
+    strncpy(header.magic, LOCATIONS_FILE_MAGIC, sizeof(header.magic));
+    header.version = LOCATIONS_FILE_VERSION;
+}
+
+bool SWIMLocationsFile::sameParameters(const locHeader &header1, const locHeader &header2)
+{
+    // compare the fields one by one as the padding of the structure
+    // is not defined
+    return strncmp(header1.magic, header2.magic, sizeof(header1.magic)) == 0
+            && header1.version == header2.version
+            && header1.noOfLocations == header2.noOfLocations
+            && header1.dimensions == header2.dimensions
+            && header1.usedRNG == header2.usedRNG
+            && header1.minAreaX == header2.minAreaX
+            && header1.minAreaY == header2.minAreaY
+            && header1.minAreaZ == header2.minAreaZ
+            && header1.maxAreaX == header2.maxAreaX
+            && header1.maxAreaY == header2.maxAreaY
+            && header1.maxAreaZ == header2.maxAreaZ
+            && header1.radius == header2.radius
+            && header1.seed == header2.seed
+            && header1.layout == header2.layout
+            && header1.clusters == header2.clusters
+            && header1.clusterRadius == header2.clusterRadius
+            && header1.minSeparation == header2.minSeparation
+            && header1.heatmapHash == header2.heatmapHash;
+}
+
+bool SWIMLocationsFile::create(const char *fileName, const locHeader &header, const std::vector<loc> &locs)
+{
+    unmap();
+
+    // the header must describe the locations that follow it
+    if((int) locs.size() != header.noOfLocations) {
+        return false;
+    }
+
+    // keep the locations in memory only, in the same layout as the file
+    if(fileName == nullptr || *fileName == '\0') {
+        buffer.resize(sizeof(header) + locs.size() * sizeof(loc));
+        memcpy(buffer.data(), &header, sizeof(header));
+        if(!locs.empty()) {
+            memcpy(buffer.data() + sizeof(header), locs.data(), locs.size() * sizeof(loc));
+        }
+        return useBuffer();
+    }
+
+    // write to a file private to this process and map it before renaming
+    // it, so that simulations running in parallel never see a partially
+    // written file and each keeps using the locations it created
+    std::string tempName = std::string(fileName) + "." + std::to_string(getpid()) + ".tmp";
+    FILE *outfile = fopen(tempName.c_str(), "wb");
+    if(outfile == nullptr) {
+        return false;
+    }
+
+    bool written = (fwrite(&header, sizeof(header), 1, outfile) == 1);
+    if(written && !locs.empty()) {
+        written = (fwrite(locs.data(), sizeof(loc), locs.size(), outfile) == locs.size());
+    }
+
+    if(fclose(outfile) != 0 || !written || !map(tempName.c_str())) {
+        remove(tempName.c_str());
+        return false;
+    }
+
+#ifdef _WIN32
+    // rename does not replace existing files
+    remove(fileName);
+#endif
+    if(rename(tempName.c_str(), fileName) != 0) {
+        remove(tempName.c_str());
+    }
+    return true;
+}
+
+bool SWIMLocationsFile::readText(const char *fileName, int noOfLocs, std::vector<loc> &locs)
+{
+    std::string line;
+    std::ifstream infile(fileName);
+
+    if(!infile.is_open()) {
+        return false;
+    }
+
+    // each line holds x, y and z followed by an (ignored) node count
+    locs.clear();
+    while((int) locs.size() < noOfLocs && getline(infile, line)) {
+        loc location;
+        if(sscanf(line.c_str(), "%lf %lf %lf", &location.myCoordX, &location.myCoordY, &location.myCoordZ) == 3) {
+            locs.push_back(location);
+        }
+    }
+    infile.close();
+
+    return ((int) locs.size() == noOfLocs);
+}
+
+bool SWIMLocationsFile::writeText(const char *fileName, const loc *locs, int noOfLocs)
+{
+    std::ofstream outfile(fileName, std::ios::out|std::ios::trunc);
+
+    if(!outfile.is_open()) {
+        return false;
+    }
+
+    for(int i = 0; i < noOfLocs; i++) {
+        outfile << locs[i].myCoordX << " " << locs[i].myCoordY << " " << locs[i].myCoordZ
+                << " " << 0 << "\n";
+    }
+    outfile.close();
+
+    return !outfile.fail();
+}
+
+bool SWIMLocationsFile::map(const char *fileName)
+{
+    unmap();
+
+#ifndef _WIN32
+    int fd = open(fileName, O_RDONLY);
+    if(fd < 0) {
+        return false;
+    }
+
+    struct stat fileStat;
+    if(fstat(fd, &fileStat) != 0 || fileStat.st_size < (off_t) sizeof(locHeader)) {
+        close(fd);
+        return false;
+    }
+
+    // the mapping stays valid after the descriptor is closed
+    void *data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED) {
+        return false;
+    }
+    mapping = data;
+    mappingSize = fileStat.st_size;
+
+    return useMapping();
+#else
+    // no memory mapping, so keep a copy of the file in memory
+    std::ifstream infile(fileName, std::ios::in|std::ios::binary);
+    if(!infile.is_open()) {
+        return false;
+    }
+    buffer.assign(std::istreambuf_iterator<char>(infile), std::istreambuf_iterator<char>());
+    return useBuffer();
+#endif
+}
+
+bool SWIMLocationsFile::useBuffer()
+{
+    if(buffer.size() < sizeof(locHeader)) {
+        buffer.clear();
+        return false;
+    }
+    mapping = buffer.data();
+    mappingSize = buffer.size();
+
+    return useMapping();
+}
+
+bool SWIMLocationsFile::useMapping()
+{
+    // check that the data is a locations file and that it holds
+    // all the locations given in the header
+    memcpy(&header, mapping, sizeof(header));
+    if(strncmp(header.magic, LOCATIONS_FILE_MAGIC, sizeof(header.magic)) != 0
+            || header.version != LOCATIONS_FILE_VERSION
+            || header.noOfLocations < 0
+            || mappingSize < sizeof(header) + header.noOfLocations * sizeof(loc)) {
+        unmap();
+        return false;
+    }
+
+    locations = (const loc *) ((const char *) mapping + sizeof(header));
+    return true;
+}
+
+void SWIMLocationsFile::unmap()
+{
+#ifndef _WIN32
+    if(mapping != nullptr && buffer.empty()) {
+        munmap(mapping, mappingSize);
+    }
+#endif
+    buffer.clear();
+
+    memset(&header, 0, sizeof(header));
+    locations = nullptr;
+    mapping = nullptr;
+    mappingSize = 0;
+}
+
+} // namespace inet
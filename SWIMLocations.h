@@ -0,0 +1,137 @@
+/******************************************************************************
+ * SWIMMobility - A SWIM implementation for the INET Framework of the OMNeT++
+ * Simulator.
+ *
+ * Copyright (C) 2016, Sustainable Communication Networks, University of Bremen, Germany
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ *
+ ******************************************************************************/
+
+/**
+* The C++ include file of the locations file used by the SWIM mobility model.
+* Locations are kept in a binary file with a header that records the
+* parameters used to create them. The file is mapped read-only once per
+* simulation and shared by all the SWIM nodes.
+*
+* @author : Anas bin Muslim (anas1@uni-bremen.de)
+*
+*/
+
+#ifndef __INET_SWIMLOCATIONS_H
+#define __INET_SWIMLOCATIONS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#include "inet/mobility/single/SWIMDefs.h"
+
+#define LOCATIONS_FILE_MAGIC    "SWIMLOC"
+#define LOCATIONS_FILE_VERSION  2
+
+struct loc {
+    double myCoordX;
+    double myCoordY;
+    double myCoordZ;
+};
+
+// header at the start of the binary locations file; all the fields
+// except magic and version are the parameters used to create the
+// locations (the fingerprint)
+struct locHeader {
+    char magic[8];
+    uint32_t version;
+    int32_t noOfLocations;
+    int32_t dimensions;
+    int32_t usedRNG;
+
+    double minAreaX;
+    double minAreaY;
+    double minAreaZ;
+    double maxAreaX;
+    double maxAreaY;
+    double maxAreaZ;
+    double radius;
+
+    uint64_t seed;
+
+    // layout of the created locations (see SWIMLocationGenerator), with
+    // the fingerprint of the heatmap file
+    int32_t layout;
+    int32_t clusters;
+    double clusterRadius;
+    double minSeparation;
+    uint64_t heatmapHash;
+};
+
+namespace inet {
+
+class INET_API SWIMLocationsFile
+{
+protected:
+    locHeader header;
+    const loc *locations;
+
+    void *mapping;
+    size_t mappingSize;
+
+    // used where memory mapping is not available or when
+    // locations are kept in memory only
+    std::vector<char> buffer;
+
+protected:
+    /** Takes the header and locations from the buffer **/
+    bool useBuffer();
+
+    /** Checks the header of the mapped data and locates the locations **/
+    bool useMapping();
+
+public:
+    /** Constructor **/
+    SWIMLocationsFile();
+
+    /** Destructor **/
+    ~SWIMLocationsFile();
+
+    /** Fills magic and version of the given header **/
+    static void initHeader(locHeader &header);
+
+    /** Checks whether both headers hold the same parameters **/
+    static bool sameParameters(const locHeader &header1, const locHeader &header2);
+
+    /** Writes the header and the locations in binary format and maps them (kept in memory only when no file name is given) **/
+    bool create(const char *fileName, const locHeader &header, const std::vector<loc> &locs);
+
+    /** Reads locations from a text file (x y z [count] per line) **/
+    static bool readText(const char *fileName, int noOfLocs, std::vector<loc> &locs);
+
+    /** Writes locations to a text file (x y z count per line) **/
+    static bool writeText(const char *fileName, const loc *locs, int noOfLocs);
+
+    /** Maps the given file read-only **/
+    bool map(const char *fileName);
+
+    /** Releases the mapping **/
+    void unmap();
+
+    bool isMapped() const { return locations != nullptr; }
+    const locHeader &getHeader() const { return header; }
+    const loc *getLocations() const { return locations; }
+    int getNoOfLocations() const { return header.noOfLocations; }
+};
+
+}//namespace inet
+
+#endif
@@ -41,28 +41,75 @@
  */
 
 #include <algorithm>
+#include <map>
+#include <mutex>
+#include <thread>
 
 #include "inet/mobility/single/SWIMMobility.h"
+#include "inet/mobility/single/SWIMTraceGenerator.h"
 
 namespace inet{
 
 Define_Module(SWIMMobility);
 
-bool sortByWeight(const nodeProp &a, const nodeProp &b) { return (a.weight > b.weight); }
-bool locationsCreated = 0;
+// shared state of every simulation (there may be many in a process),
+// which expires when the last node of that simulation is deleted
+std::map<cSimulation *, std::weak_ptr<swimShared>> sharedStates;
+std::mutex sharedStatesMutex;
+
+std::shared_ptr<swimShared> findSharedState(cSimulation *simulation)
+{
+    std::lock_guard<std::mutex> lock(sharedStatesMutex);
+
+    // forget the states of simulations that are gone (whose address may
+    // be taken by a later one)
+    for(auto it = sharedStates.begin(); it != sharedStates.end(); ) {
+        if(it->second.expired()) {
+            it = sharedStates.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    std::shared_ptr<swimShared> state = sharedStates[simulation].lock();
+    if(!state) {
+        state = std::make_shared<swimShared>();
+        sharedStates[simulation] = state;
+    }
+    return state;
+}
 
 SWIMMobility::SWIMMobility()
 {
     nextMoveIsWait = false;
     created = false;
-    firstStep = true;
     count = 0;
     homeCoordFound = false;
+    replayNode = -1;
+    warmUpTime = 0.0;
+    warmUpIndex = -1;
+    stateNode = -1;
+    restorePending = false;
+    waitTimePar = nullptr;
+    waitTimeIsExpression = false;
+    waitTime = 0.0;
+    mergeWaitAndMove = false;
+    segmentHasWait = false;
+    lazyPositionUpdates = false;
+    locationThreads = 1;
+    deciderSlot = -1;
 }
 
 void SWIMMobility::finish()
 {
-    locationsCreated = 0;
+    // nothing to reset for the next run, the shared state is
+    // released when the nodes are deleted
+    if(!saveStateFile.empty()) {
+        saveState();
+    }
+    if(!statsFile.empty() && replayTraceFile.empty()) {
+        writeStats();
+    }
 }
 
 void SWIMMobility::initialize(int stage)
@@ -86,78 +133,192 @@ void SWIMMobility::initialize(int stage)
         nodes = par("Hosts");
         dimensions = par("dimensions");
         recreateLocationsFile = par("recreateLocationsFile");
+        locationsFileName = par("locationsFile").stdstringValue();
+        cacheLocationWeights = par("cacheLocationWeights");
+        fastDiscSampling = par("fastDiscSampling");
+        batchedRandomNumbers = par("batchedRandomNumbers");
+        implicitVisiting = par("implicitVisitingLocations");
+        importLocationsFile = par("importLocationsFile").stdstringValue();
+        exportLocationsFile = par("exportLocationsFile").stdstringValue();
+        replayTraceFile = par("replayTraceFile").stdstringValue();
+        mergeWaitAndMove = par("mergeWaitAndMove");
+        lazyPositionUpdates = par("lazyPositionUpdates");
+        restoreStateFile = (replayTraceFile.empty() ? par("restoreStateFile").stdstringValue() : "");
+        saveStateFile = (replayTraceFile.empty() ? par("saveStateFile").stdstringValue() : "");
+        statsFile = par("statsFile").stdstringValue();
+        warmUpTime = (replayTraceFile.empty() && restoreStateFile.empty() ? par("warmUpTime").doubleValue() : 0.0);
+        warmUpIndex = -1;
+        stateNode = -1;
+        restorePending = false;
+
+        std::string destinationSelection = par("destinationSelection").stdstringValue();
+        if(destinationSelection != "popularity" && destinationSelection != "weighted") {
+            throw cRuntimeError("SWIM :: Unknown destinationSelection '%s' (popularity or weighted)", destinationSelection.c_str());
+        }
+        weightedSelection = (destinationSelection == "weighted");
+
+        std::string layout = par("locationLayout").stdstringValue();
+        if(!SWIMLocationGenerator::parseLayout(layout, locationLayout.layout)) {
+            throw cRuntimeError("SWIM :: Unknown locationLayout '%s' (uniform, thomas, matern or heatmap)", layout.c_str());
+        }
+        locationLayout.clusters = par("locationClusters");
+        locationLayout.clusterRadius = par("clusterRadius");
+        locationLayout.minSeparation = par("minLocationSeparation");
+        locationLayout.heatmapFile = par("locationHeatmapFile").stdstringValue();
+        locationLayout.threads = par("locationThreads");
 
         maxAreaX = constraintAreaMax.x;
         maxAreaY = constraintAreaMax.y;
         maxAreaZ = constraintAreaMax.z;
         nextMoveIsWait = false;
+        segmentHasWait = false;
         created = false;
-        firstStep = true;
         count = 0;
         homeCoordFound = false;
 
-        // radius should never be zero
-        if(radius == 0) {
-            radius = 1;
+        // with lazy updates, nodes are only updated at the end of a
+        // segment, and in between only when their position is asked for
+        if(lazyPositionUpdates) {
+            updateInterval = 0;
         }
 
-        // extend array to hold all the locations
-        locations.resize((noOfLocs));
-        
-        // if recreateLocationsFile true and file exists, remove it
-        if (!locationsCreated && recreateLocationsFile) {
-            std::ifstream infile(LOCATIONS_FILE);
-            if(infile) {
-                infile.close();
-                remove(LOCATIONS_FILE);
-            }
-            
-        } else {
+        // a wait time given as a constant is the same at every target
+        // (although volatile), so only an expression is evaluated each time
+        waitTimePar = &par("waitTime");
+        waitTimeIsExpression = waitTimePar->isExpression();
+        waitTime = (waitTimeIsExpression ? 0.0 : waitTimePar->doubleValue());
+
+        // reset the SWIM state of the node
+        setupModel();
+
+        // the first node of the simulation creates the locations (unless
+        // an existing locations file was created with the same parameters
+        // and may be reused) to be used by all nodes.
+        shared = findSharedState(getSimulation());
+        shared->noOfNodes++;
+
+        // the crowded locations serve the implicit visiting locations and
+        // the refresh of the cached weights
+        shared->trackCrowded(minCrowdedSeen);
+
+        // with threads, the nodes deciding at the same time separate their
+        // locations at once (see prepareDecisions()); with cached weights,
+        // the locations are only separated at the first decision, which
+        // each node takes during initialization, so there is none to share
+        locationThreads = (locationLayout.threads > 0 ? locationLayout.threads : (int) std::thread::hardware_concurrency());
+        deciderSlot = -1;
+        if(locationThreads > 1 && !cacheLocationWeights && replayTraceFile.empty()) {
+            deciderSlot = shared->deciders.size();
+            shared->deciders.push_back(this);
+        }
 
-            // check if file already exists and if so, the location count is right
-            std::string line;
-            int i = 0;
-            std::ifstream infile(LOCATIONS_FILE);
-            if(infile) {
-                // read number of lines in file
-                while (getline(infile, line)) {
-                    i++;
-                }
-                // if number of line in file equals or is greater than noOfLocs
-                // use current file otherwise create new
-                if(noOfLocs <= i) {
-                    locationsCreated = 1;
+        if(!replayTraceFile.empty()) {
+
+            // in replay mode, no locations are needed as the nodes
+            // only follow their segments in the trace (and are counted
+            // at the locations they head to)
+            startReplay();
+
+        } else if(!restoreStateFile.empty()) {
+
+            // or the locations and node counts are those saved
+            startRestore();
+
+        } else if(shared->locations == nullptr) {
+            if(recreateLocationsFile || !readLocations()) {
+                if(!createLocations()) {
+                    throw cRuntimeError("SWIM :: Unable to create the locations (file '%s')", locationsFileName.c_str());
                 }
-                infile.close();
             }
+
+            // no nodes are present at any location at the start
+            shared->reset(noOfLocs, dimensions);
         }
-    
-        // one of the nodes creates the locations.txt file which
-        // will be used by all nodes.
-        if(!locationsCreated) {
-            createLocations();
-            locationsCreated = 1;
+
+    // all nodes have found their homes in the earlier stages, so
+    // the warm-up can be run for all of them
+    } else if(stage == INITSTAGE_LAST && warmUpTime > 0.0) {
+        startAfterWarmUp();
+
+    // all nodes now head to their saved locations, so the first node
+    // checks that the node counts are those saved (i.e., that the same
+    // nodes were restored)
+    } else if(stage == INITSTAGE_LAST && !restoreStateFile.empty() && !shared->restoredState.noOfNodesPresent.empty()) {
+        if(shared->noOfNodesPresent != shared->restoredState.noOfNodesPresent) {
+            throw cRuntimeError("SWIM :: The nodes do not match the nodes in the state file '%s'", restoreStateFile.c_str());
         }
+        shared->restoredState.noOfNodesPresent.clear();
     }
 }
 
+void SWIMMobility::setInitialPosition()
+{
+    // in replay mode, nodes start at their home in the trace
+    if(!replayTraceFile.empty()) {
+        homeCoordFound = true;
+        destLocId = -1;
+        lastPosition = homeCoord;
+        return;
+    }
+
+    // restored nodes start where they were saved
+    if(!restoreStateFile.empty()) {
+        homeCoordFound = true;
+        homeCoord = shared->restoredState.homes[stateNode];
+        lastPosition = shared->restoredState.states[stateNode].position;
+        restorePending = true;
+        return;
+    }
+
+    LineSegmentsMobilityBase::setInitialPosition();
+}
+
 void SWIMMobility::setTargetPosition()
 {
+    // in replay mode, the segments are not computed but read
+    if(!replayTraceFile.empty()) {
+        replayTargetPosition();
+        return;
+    }
+    segmentHasWait = false;
+
+    // restored nodes continue the move or wait they were in
+    if(restorePending) {
+        const swimNodeState &state = shared->restoredState.states[stateNode];
+        targetPosition = state.target;
+        nextChange = simTime() + (state.endTime - shared->restoredState.time);
+        destLocId = state.locId;
+        nextMoveIsWait = state.waitNext;
+        firstStep = false;
+        restorePending = false;
+        updateAllNodes(true);
+        queueDecision();
+        return;
+    }
 
     // initial position of a node is considered as the home
     // location
     if (!homeCoordFound) {
         homeCoordFound = true;
         homeCoord = this->getCurrentPosition();
-        neew = homeCoord;
+        destLocId = -1;
         lastPosition = homeCoord;
+
+        // with a warm-up, the node stays at home until all the homes
+        // are known and it is started in its state after the warm-up
+        if(warmUpTime > 0.0) {
+            warmUpIndex = shared->warmUpHomes.size();
+            shared->warmUpHomes.push_back(homeCoord);
+            targetPosition = lastPosition;
+            nextChange = -1;
+            return;
+        }
     }
 
     // a nodes switches between moving and waiting
     // if the next  action is to wait, give the waiting time
     if(nextMoveIsWait){
-        simtime_t waitTime = par("waitTime");
-        nextChange = simTime() + waitTime.dbl();
+        nextChange = simTime() + nextWaitTime();
 
         // begin temp code
         // EV << simTime() << " :: SWIM :: nextMoveIsWait wait :: node id :: " << getId()
@@ -166,411 +327,527 @@ void SWIMMobility::setTargetPosition()
 
         // if the next action is to start moving, compute the next location to move
     } else {
-        double randomNum = uniform(0.0, 1.0, usedRNG);
-        double returnHomeDecimalFraction = returnHomePercentage / 100.0;
-
-        // randomly base to where the next move will be; home or
-        // other location (neighboring or visiting), provided that
-        // node is not already at home location
-        if(randomNum < returnHomeDecimalFraction && lastPosition != homeCoord) {
-
-            if(!firstStep) {
-                updateAllNodes(false);
-            }
-
-            // select home location to move to
-            targetPosition = homeCoord;
-
-            // compute next change time based on distance to the next
-            // loation to move to and speed
-            Coord positionDelta = targetPosition - lastPosition;
-            double distance = positionDelta.length();
-            nextChange = simTime() + distance/speed;
+        if(deciderSlot >= 0) {
+            prepareDecisions();
+        }
 
-            // begin temp code
-            // EV << simTime() << " :: SWIM :: not nextMoveIsWait home :: node id :: " << getId() << " :: target pos :: x pos :: " << targetPosition.x
-            //     << " :: y pos :: " << targetPosition.y << " :: next change " << nextChange << "\n";
-            // end temp code
+        // select home or the neighbouring or visiting location
+        // to move to (see SWIMModel)
+        targetPosition = nextTargetPosition(lastPosition);
+
+        // compute next change time based on distance to the next
+        // loation to move to and speed
+        Coord positionDelta = targetPosition - lastPosition;
+        double distance = positionDelta.length();
+        nextChange = simTime() + distance/speed;
+
+        // the wait at the target may be taken in the same segment,
+        // which saves the event in between
+        if(mergeWaitAndMove) {
+            segmentHasWait = true;
+            arrivalTime = nextChange;
+            nextChange = arrivalTime + nextWaitTime();
+        }
 
+        // begin temp code
+        // EV << simTime() << " :: SWIM :: not nextMoveIsWait :: node id :: " << getId() << " :: target pos :: x pos :: " << targetPosition.x
+        //     << " :: y pos :: " << targetPosition.y << " :: next change " << nextChange << "\n";
+        // end temp code
+    }
 
-        } else {
+    // indicate first time actions are all done
+    firstStep = false;
 
-            // select the neighbouring or visiting location to move to
+    // next action is the opposit of current action (a move, after
+    // a move with its wait)
+    nextMoveIsWait = !nextMoveIsWait && !segmentHasWait;
+    queueDecision();
+}
 
-            // read the locations from the locations.txt, but only
-            // once (firstStep)
-            if(firstStep){
-                readLocations();
-            }
+void SWIMMobility::queueDecision()
+{
+    if(deciderSlot >= 0 && !nextMoveIsWait && nextChange >= simTime()) {
+        shared->decisionTimes.push(std::make_pair(nextChange.dbl(), deciderSlot));
+    }
+}
 
-            // compute the weights assignd to each node
-            seperateAndUpdateWeights();
+void SWIMMobility::prepareDecisions()
+{
+    simtime_t now = simTime();
+    if(shared->preparedTime == now.dbl()) {
+        return;
+    }
+    shared->preparedTime = now.dbl();
+
+    // the decisions queued up to now were taken (or the nodes deleted or
+    // rescheduled), so only the nodes still deciding now are prepared
+    std::vector<SWIMModel *> preparing;
+    auto &decisionTimes = shared->decisionTimes;
+    while(!decisionTimes.empty() && decisionTimes.top().first <= now.dbl()) {
+        SWIMMobility *node = static_cast<SWIMMobility *>(shared->deciders[decisionTimes.top().second]);
+        if(decisionTimes.top().first == now.dbl() && node != nullptr && node->nextChange == now && node->needsLocations()) {
+            preparing.push_back(node);
+        }
+        decisionTimes.pop();
+    }
+    SWIMModel::prepareLocationsOf(preparing, locationThreads);
+}
 
-            // update the seen count (i.e., decrement nodes), but not at the begining
-            // as locations have not seen any nodes yet
-            if(!firstStep) {
-                updateAllNodes(false);
-            }
+void SWIMMobility::initializePosition()
+{
+    LineSegmentsMobilityBase::initializePosition();
+    startSegment();
+}
 
-            // find the next location (position) to move to
-            targetPosition = decision();
+void SWIMMobility::move()
+{
+    simtime_t now = simTime();
 
-            // compute next change time based on distance to the next
-            // loation to move to and speed
-            Coord positionDelta = targetPosition - lastPosition;
+    // at the end of a segment, the next one is taken
+    if(now == nextChange) {
+        LineSegmentsMobilityBase::move();
+        startSegment();
+        return;
+    }
 
-            double distance = positionDelta.length();
-            nextChange = simTime() + distance/speed;
+    // otherwise the position follows from the segment, which was
+    // checked to be within the area when it started
+    if(now >= arrivalTime) {
+        lastPosition = targetPosition;
+        lastSpeed = Coord::ZERO;
+    } else {
+        lastPosition = moveStart + lastSpeed * (now - moveStartTime).dbl();
+    }
+}
 
-            // begin temp code
-            // EV << simTime() << " :: SWIM :: not nextMoveIsWait other :: node id :: " << getId() << " :: target pos :: x pos :: " << targetPosition.x
-            //     << " :: y pos :: " << targetPosition.y << " :: next change " << nextChange << "\n";
-            // end temp code
+void SWIMMobility::startSegment()
+{
+    simtime_t now = simTime();
 
-            // update the seen count (i.e., increment nodes)
-            updateAllNodes(true);
-        }
+    // without a wait in the segment, the node arrives at its end
+    moveStart = lastPosition;
+    moveStartTime = now;
+    if(!segmentHasWait) {
+        arrivalTime = (nextChange > now ? nextChange : now);
     }
+    lastSpeed = (arrivalTime > now ? (targetPosition - moveStart) / (arrivalTime - now).dbl() : Coord::ZERO);
 
-    // indicate first time actions are all done
-    firstStep = false;
+    // the area is a box, so the segment is within it when both of its
+    // ends are
+    raiseErrorIfOutside();
+    if(!isInsideArea(targetPosition)) {
+        throw cRuntimeError("SWIM :: Target position (%g, %g, %g) is outside the constraint area",
+                targetPosition.x, targetPosition.y, targetPosition.z);
+    }
+}
 
-    // next action is the opposit of current action
-    nextMoveIsWait = !nextMoveIsWait;
+bool SWIMMobility::isInsideArea(const Coord &position) const
+{
+    return position.x >= constraintAreaMin.x && position.x <= constraintAreaMax.x
+            && position.y >= constraintAreaMin.y && position.y <= constraintAreaMax.y
+            && position.z >= constraintAreaMin.z && position.z <= constraintAreaMax.z;
 }
 
-void SWIMMobility::move()
+double SWIMMobility::nextWaitTime()
 {
-    // this method is called every time the node moves
-    LineSegmentsMobilityBase::move();
-    raiseErrorIfOutside();
+    return (waitTimeIsExpression ? waitTimePar->doubleValue() : waitTime);
 }
 
-bool SWIMMobility::createLocations(){
-    bool opn = false;
+double SWIMMobility::drawUniform(double a, double b)
+{
+    return uniform(a, b, usedRNG);
+}
 
-    // open the file in output mode
-    std::ofstream outfile;
-    outfile.open(LOCATIONS_FILE, std::ios::out|std::ios::trunc);
+int SWIMMobility::drawIntUniform(int a, int b)
+{
+    return intuniform(a, b, usedRNG);
+}
 
-    if(outfile.is_open())
-        opn = 1;
+void SWIMMobility::drawUniformBlock(double *numbers, int count)
+{
+    cRNG *rng = getRNG(usedRNG);
+    for(int i = 0; i < count; i++) {
+        numbers[i] = rng->doubleRand();
+    }
+}
 
-    // create a set of random locations in the mobility area
-    for(int i = 0; i < noOfLocs; i++) {
+bool SWIMMobility::createLocations(){
+    bool opn = true;
+    locHeader header;
+    std::vector<loc> newLocations(noOfLocs);
 
-        // creation of locations assume the following based
-        // on the mobility area
-        // 1) constraint area must be > 0
-        // 2) constraint area must be at least > 2 times the value
-        //    defined in radius because locations are not created
-        //    at the borders
+    fillLocationsHeader(header);
 
-        if (!(maxAreaX > (radius * 4.0) && maxAreaY > (radius * 4.0))) {
-            EV << "SWIM :: Constraint area (maxAreaX or maxAreaY) is below 10 meters" << "\n";
-            opn = 0;
-            break;
+    // import the locations from a text file instead of creating them
+    if(!importLocationsFile.empty()) {
+        if(!SWIMLocationsFile::readText(importLocationsFile.c_str(), noOfLocs, newLocations)) {
+            EV << "SWIM :: Unable to import " << noOfLocs << " locations from " << importLocationsFile << "\n";
+            return false;
         }
 
-        // compute random x coord
-        // locations[i].myCoordX = (double) intuniform(0, ((int)round(maxAreaX) - 10), usedRNG);
-        double coordElem = uniform((radius * 2.0), (maxAreaX - (radius * 2.0)), usedRNG);
-        locations[i].myCoordX = (int) coordElem;
+    // otherwise create a set of random locations in the mobility area
+    } else if(!generateLocations(newLocations)) {
+        EV << "SWIM :: Constraint area is below 4 times the radius, the heatmap cannot be read or the "
+                << "minLocationSeparation leaves no room for " << noOfLocs << " locations" << "\n";
+        opn = 0;
+    }
 
-        // compute random y coord
-        // locations[i].myCoordY = (double) intuniform(0, ((int)round(maxAreaY) - 10), usedRNG);
-        coordElem = uniform((radius * 2.0), (maxAreaY - (radius * 2.0)), usedRNG);
-        locations[i].myCoordY = (int) coordElem;
+    // write to file (or keep in memory when no file name is given)
+    if(opn) {
+        opn = shared->locationsFile.create(locationsFileName.c_str(), header, newLocations);
+    }
 
-        // z coord is always 0
-        if(dimensions == 3){
-            coordElem = uniform((radius * 2.0), (maxAreaZ - (radius * 2.0)), usedRNG);
-            locations[i].myCoordZ = (int) coordElem;
-        } else {
-            locations[i].myCoordZ = 0.0;
+    // keep a text copy, if requested
+    if(opn && !exportLocationsFile.empty()) {
+        if(!SWIMLocationsFile::writeText(exportLocationsFile.c_str(), newLocations.data(), noOfLocs)) {
+            EV << "SWIM :: Unable to export the locations to " << exportLocationsFile << "\n";
         }
-
-        locations[i].noOfNodesPresent = 0;
-
-        // write to file
-        outfile << locations[i].myCoordX << " " << locations[i].myCoordY << " " << locations[i].myCoordZ
-                << " " << locations[i].noOfNodesPresent << endl;
     }
 
-    outfile.close();
     return opn;
 }
 
 bool SWIMMobility::readLocations()
 {
+    locHeader header;
 
-    // open location file to read
-    std::ifstream infile;
-    infile.open("locations.txt", std::ios::in);
-
-    // if coudn't open, then problem
-    if(!(infile.is_open())) {
-        return 0;
+    // map location file to read
+    if(locationsFileName.empty() || !shared->locationsFile.map(locationsFileName.c_str())) {
+        return false;
     }
 
-    // read all the values into locations array
-    for(int i=0;i<noOfLocs;i++){
-        infile >> locations[i].myCoordX;
-        infile >> locations[i].myCoordY;
-        infile >> locations[i].myCoordZ;
-        infile >> locations[i].noOfNodesPresent;
+    // if the file was created with other parameters, then problem
+    fillLocationsHeader(header);
+    if(!SWIMLocationsFile::sameParameters(shared->locationsFile.getHeader(), header)) {
+        shared->locationsFile.unmap();
+        return false;
     }
 
-    // close file
-    infile.close();
-
     return true;
 }
 
-void SWIMMobility::seperateAndUpdateWeights()
+void SWIMMobility::fillLocationsHeader(locHeader &header)
 {
-    Coord temp;
-    int noOfNeighbors = 0, n = 0, v = 0;
-
-    // compute the maximum possible weight (to normalize)
-    double maxWeight = alpha * ( sqrt( pow(maxAreaX, 2.0) + pow(maxAreaY, 2.0) + pow(maxAreaZ, 2.0)) ) + (1.0 - alpha) * nodes;
+    SWIMLocationsFile::initHeader(header);
+
+    header.noOfLocations = noOfLocs;
+    header.dimensions = dimensions;
+    header.usedRNG = usedRNG;
+    header.minAreaX = constraintAreaMin.x;
+    header.minAreaY = constraintAreaMin.y;
+    header.minAreaZ = constraintAreaMin.z;
+    header.maxAreaX = maxAreaX;
+    header.maxAreaY = maxAreaY;
+    header.maxAreaZ = maxAreaZ;
+    header.radius = radius;
+
+    // the seed set of the run decides the random numbers used to
+    // create the locations
+    const char *seedSet = getEnvir()->getConfigEx()->getVariable(CFGVAR_SEEDSET);
+    header.seed = (seedSet != nullptr ? strtoull(seedSet, nullptr, 10) : 0);
+
+    // the parameters of the layout that are used
+    header.layout = locationLayout.layout;
+    header.minSeparation = locationLayout.minSeparation;
+    if(locationLayout.layout == LAYOUT_THOMAS || locationLayout.layout == LAYOUT_MATERN) {
+        header.clusters = locationLayout.clusters;
+        header.clusterRadius = locationLayout.clusterRadius;
+    } else if(locationLayout.layout == LAYOUT_HEATMAP) {
+        header.heatmapHash = SWIMLocationGenerator::hashFile(locationLayout.heatmapFile.c_str());
+    }
 
-    // compute how many neighboring locations exist
-    for(int i = 0; i < noOfLocs; i++) {
-        temp.x = locations[i].myCoordX;
-        temp.y = locations[i].myCoordY;
-        temp.z = locations[i].myCoordZ;
+    // imported locations do not depend on random numbers (or the layout)
+    if(!importLocationsFile.empty()) {
+        header.usedRNG = -1;
+        header.seed = 0;
+        header.layout = -1;
+        header.minSeparation = 0.0;
+        header.clusters = 0;
+        header.clusterRadius = 0.0;
+        header.heatmapHash = 0;
+    }
+}
 
-        if(temp.distance(homeCoord) <= neighbourLocationLimit){
-            noOfNeighbors++;
+void SWIMMobility::startReplay()
+{
+    // the first node of the simulation opens the trace file, which
+    // is then shared by all nodes
+    if(!shared->replayTrace.isOpen()) {
+        if(!shared->replayTrace.open(replayTraceFile.c_str())) {
+            throw cRuntimeError("SWIM :: Unable to open the trace file '%s'", replayTraceFile.c_str());
         }
+
+        // the nodes are counted at the locations of the trace, which
+        // need no positions for that
+        shared->resetCounts(shared->replayTrace.getNoOfLocations());
     }
+    noOfLocs = shared->replayTrace.getNoOfLocations();
 
-    // adjust arrays to hold the neighboring and visiting locations
-    neighborLocs.resize((noOfNeighbors));
-    visitingLocs.resize((noOfLocs - noOfNeighbors));
+    replayNode = findNodeIndex();
 
+    if(!shared->replayTrace.start(replayNode, homeCoord, replayCursor)) {
+        throw cRuntimeError("SWIM :: Node %d is not in the trace file '%s' (%d nodes)", replayNode,
+                replayTraceFile.c_str(), shared->replayTrace.getNoOfNodes());
+    }
+    claimNodeIndex(shared->replayedNodes, replayNode, shared->replayTrace.getNoOfNodes(), replayTraceFile);
+}
 
-    // separate the locations into neighboring and visiting locations
-    // and compute the weight assigned to each location
-    for(int i = 0; i < noOfLocs; i++) {
-        temp.x = locations[i].myCoordX;
-        temp.y = locations[i].myCoordY;
-        temp.z = locations[i].myCoordZ;
+void SWIMMobility::replayTargetPosition()
+{
+    traceRecord record;
+
+    // at the end of the trace, the node stays where it is
+    if(!shared->replayTrace.next(replayCursor, record)) {
+        nextChange = -1;
+        stationary = true;
+        targetPosition = lastPosition;
+        return;
+    }
 
-        if(temp.distance(homeCoord) <= neighbourLocationLimit) {
-            neighborLocs[n].locCoordX = locations[i].myCoordX;
-            neighborLocs[n].locCoordY = locations[i].myCoordY;
-            neighborLocs[n].locCoordZ = locations[i].myCoordZ;
-            neighborLocs[n].seen = locations[i].noOfNodesPresent;
-            neighborLocs[n].weight = (alpha * (temp.distance(homeCoord)) + (1.0 - alpha) * neighborLocs[n].seen);
-            neighborLocs[n].weight = neighborLocs[n].weight / maxWeight;
-            n++;
-        } else {
-            visitingLocs[v].locCoordX = locations[i].myCoordX;
-            visitingLocs[v].locCoordY = locations[i].myCoordY;
-            visitingLocs[v].locCoordZ = locations[i].myCoordZ;
-            visitingLocs[v].seen = locations[i].noOfNodesPresent;
-            visitingLocs[v].weight = (alpha * (temp.distance(homeCoord)) + (1.0 - alpha) * visitingLocs[v].seen);
-            visitingLocs[v].weight = visitingLocs[v].weight / maxWeight;
-            v++;
-        }
+    if(record.endTime < simTime().dbl()) {
+        throw cRuntimeError("SWIM :: Segment of node %d in the trace file '%s' ends before the current time",
+                replayNode, replayTraceFile.c_str());
+    }
+
+    targetPosition.x = record.targetX;
+    targetPosition.y = record.targetY;
+    targetPosition.z = record.targetZ;
+    nextChange = record.endTime;
+
+    // the node is counted at the location it heads to (and stays at),
+    // as when the segments are computed
+    if(record.locId != destLocId) {
+        updateAllNodes(false);
+        destLocId = record.locId;
+        updateAllNodes(true);
     }
 }
 
-// make the decision of which location to go to next
-Coord SWIMMobility::decision()
+void SWIMMobility::startAfterWarmUp()
 {
-    Coord dest;
-    nodeProp temp;
-
-    // order the neighbor & visiting locations lists by the weight
-    sort(neighborLocs.begin(), neighborLocs.end(), sortByWeight);
-    sort(visitingLocs.begin(), visitingLocs.end(), sortByWeight);
-
-    // the procedure of identifying the next location is as follows
-    // 1) decide randomly what type of location to go to next (neighboring or visiting)
-    //    using the alpha parameter
-    //    if alpha is lower, more likely to choose a visisting location
-    //    if alpha is larger, more likely to choose a neighbouring location
-    // 2) call chooseDestination() to select the destination to go to
-    // 3) if there are no locations selected by chooseDestination() based on
-    //    the given list (i.e., neighboring or visiting), check in the other
-    //    list (i.e., visiting or neighbouring)
-
-    // get random number between 0 & 1 (included)
-    double randomNumber = uniform(0.0, 1.0, usedRNG);
-    if (randomNumber <= alpha) {
-
-        // if random number is lowr than alpha, choose a neighbor location as
-        // next destination
-        dest = chooseDestination(neighborLocs);
-
-        // must be a valid destination
-        if(!(dest.x <= 0 && dest.y <= 0 && dest.z <= 0)) {
-            return dest;
-
-            // if there was a invalid destination, choose visiting location
-            // as next destination (NL 0 0 0)
-        } else {
-            return chooseDestination(visitingLocs);
+    // the first node runs the warm-up of all the nodes without
+    // OMNeT++, at the homes of the nodes and the same locations
+    if(shared->warmUpStates.empty()) {
+        swimParams params;
+        params.hosts = nodes;
+        params.noOfLocations = noOfLocs;
+        params.popularityDecisionThreshold = popularityDecisionThreshold;
+        params.returnHomePercentage = returnHomePercentage;
+        params.dimensions = dimensions;
+        params.neighbourLocationLimit = neighbourLocationLimit;
+        params.radius = radius;
+        params.alpha = alpha;
+        params.speed = speed;
+        params.waitTime = nextWaitTime();
+        params.maxAreaX = maxAreaX;
+        params.maxAreaY = maxAreaY;
+        params.maxAreaZ = maxAreaZ;
+        params.seed = drawIntUniform(0, INT32_MAX - 1);
+        params.cacheLocationWeights = cacheLocationWeights;
+        params.weightedSelection = weightedSelection;
+        params.fastDiscSampling = fastDiscSampling;
+        params.batchedRandomNumbers = batchedRandomNumbers;
+        params.implicitVisiting = implicitVisiting;
+        params.threads = locationThreads;
+
+        std::vector<loc> locs(shared->locations, shared->locations + noOfLocs);
+        SWIMTraceGenerator generator(params);
+        if(!generator.setup(&locs, &shared->warmUpHomes)) {
+            throw cRuntimeError("SWIM :: Unable to set up the warm-up");
         }
+        generator.runUntil(warmUpTime, shared->warmUpStates);
+    }
 
-    } else {
+    // continue from where the node is at the end of the warm-up, with
+    // the node count of the location it heads to
+    const swimNodeState &state = shared->warmUpStates[warmUpIndex];
+    lastPosition = state.position;
+    targetPosition = state.target;
+    nextChange = simTime() + (state.endTime - warmUpTime);
+    destLocId = state.locId;
+    nextMoveIsWait = state.waitNext;
+    firstStep = false;
+    updateAllNodes(true);
+    queueDecision();
 
-        // if random number is lowr than alpha, choose a visiting location as
-        // next destination
-        dest  = chooseDestination(visitingLocs);
-        if (!(dest.x <= 0.0 && dest.y <= 0.0 && dest.z <= 0.0)) {
-            return dest;
+    startSegment();
+    lastUpdate = simTime();
+    scheduleUpdate();
+    emitMobilityStateChangedSignal();
+}
 
-            // if there was a invalid destination, choose neighbor location
-            // as next destination (VL 0 0 0)
-        } else {
-            return chooseDestination(neighborLocs);
+int SWIMMobility::findNodeIndex()
+{
+    // the nodes are found in a file by their index, unless given
+    int node = par("replayNodeIndex");
+    if(node < 0) {
+        if(!getParentModule()->isVector()) {
+            throw cRuntimeError("SWIM :: Host %s is not in a vector, so its node in the file must be given (set replayNodeIndex)",
+                    getParentModule()->getFullPath().c_str());
         }
+        node = getParentModule()->getIndex();
     }
+    return node;
 }
 
-// select a destination randomly from the given aray (i.e., neighboring
-// locations array or visiting locations array)
-Coord SWIMMobility::chooseDestination(std::vector<nodeProp> &array)
+void SWIMMobility::claimNodeIndex(std::vector<bool> &taken, int node, int noOfFileNodes, const std::string &fileName)
 {
-    int size = array.size();
-    int randomNum = 0;
-    int popular = 0;
-    int notPopular = 0;
-
-    Coord temp;
-    Coord target;
-
-    // if array has no elements, then return
-    if (size == 0) {
-        temp.x = 0.0;
-        temp.y = 0.0;
-        temp.z = 0.0;
-        return temp;
-    }
-
-    // count the total number of popular locations based on
-    // previously computed weight values
-    for(int i = 0; i < size; i++){
-        if(array[i].weight > 0.75) {
-            popular++;
-        }
+    // hosts of different vectors (or with the same replayNodeIndex)
+    // would otherwise share a node of the file
+    taken.resize(noOfFileNodes, false);
+    if(taken[node]) {
+        throw cRuntimeError("SWIM :: Node %d of the file '%s' is taken by two hosts (set replayNodeIndex)", node, fileName.c_str());
     }
+    taken[node] = true;
+}
 
-    // compute the not-popular locations
-    notPopular = size - popular;
-
-    // choose a destination from the given array in the following manner
-    // 1) obtain a random number and check if a popular or not popular
-    //    item is selected (i.e., popularityDecisionThreshold)
-    // 2) if popular item to be selected and the popular range has items,
-    //    select an item in the popular range, randomly
-    // 3) if not popular to be selected and the not popular range has items,
-    //    select an item in the not popular range, randomly
-    // 4) if none of the above, select an item from the whole array,
-    //    randomly
-
-    randomNum = intuniform(0, 10, usedRNG);
-    if(popular > 0 && randomNum > (10 - popularityDecisionThreshold)) {
-        randomNum = intuniform(0, (popular - 1), usedRNG);
-        temp.x = array[randomNum].locCoordX;
-        temp.y = array[randomNum].locCoordY;
-        temp.z = array[randomNum].locCoordZ;
-
-    } else if (notPopular > 0) {
-        randomNum = intuniform(0, (notPopular - 1), usedRNG);
-        temp.x = array[popular + randomNum].locCoordX;
-        temp.y = array[popular + randomNum].locCoordY;
-        temp.z = array[popular + randomNum].locCoordZ;
+void SWIMMobility::startRestore()
+{
+    SWIMSnapshot &state = shared->restoredState;
 
-    } else {
-        randomNum = intuniform(0, (size - 1), usedRNG);
-        temp.x = array[randomNum].locCoordX;
-        temp.y = array[randomNum].locCoordY;
-        temp.z = array[randomNum].locCoordZ;
+    // the first node of the simulation reads the state file and uses
+    // its locations, where the nodes are placed later on
+    if(state.isEmpty()) {
+        if(!state.read(restoreStateFile.c_str())) {
+            throw cRuntimeError("SWIM :: Unable to read the state file '%s'", restoreStateFile.c_str());
+        }
+        if((int) state.locations.size() != noOfLocs) {
+            throw cRuntimeError("SWIM :: The state file '%s' has %d locations instead of %d", restoreStateFile.c_str(),
+                    (int) state.locations.size(), noOfLocs);
+        }
 
+        locHeader header;
+        fillLocationsHeader(header);
+        if(!shared->locationsFile.create(nullptr, header, state.locations)) {
+            throw cRuntimeError("SWIM :: Unable to use the locations of the state file '%s'", restoreStateFile.c_str());
+        }
+        shared->reset(noOfLocs, dimensions);
     }
 
-    double u, v, w, t, x, y;
+    stateNode = findNodeIndex();
+    if(stateNode < 0 || stateNode >= state.getNoOfNodes()) {
+        throw cRuntimeError("SWIM :: Node %d is not in the state file '%s' (%d nodes)", stateNode,
+                restoreStateFile.c_str(), state.getNoOfNodes());
+    }
+    claimNodeIndex(shared->restoredNodes, stateNode, state.getNoOfNodes(), restoreStateFile);
+}
 
-    // find a position within the radius given from the selected location
-    // to move to
-    // REASON: don't want all the nodes to pile up at the center of the
-    // location
-    u = uniform(0, 1, usedRNG);
-    v = uniform(0, 1, usedRNG);
-    w = radius * sqrt(u);
-    t = 2 * PI * v;
-    x = w * cos(t);
-    y = w * sin(t);
+void SWIMMobility::saveState()
+{
+    SWIMSnapshot &state = shared->savedState;
+    int node = findNodeIndex();
 
-    target.x = temp.x + x;
-    target.y = temp.y + y;
-    target.z = temp.z;
+    if(node < 0 || node >= shared->noOfNodes) {
+        throw cRuntimeError("SWIM :: Node %d cannot be saved with %d nodes (set replayNodeIndex)", node, shared->noOfNodes);
+    }
+    claimNodeIndex(shared->savedNodes, node, shared->noOfNodes, saveStateFile);
 
-    // temporary code to place node at the center of the location
-    // and not to spread inside the radius.
-    //target = temp;
+    // the position is brought up to the current time first
+    Coord position = getCurrentPosition();
 
-    // save position for node count computation
-    neew = temp;
+    if(shared->noOfSavedNodes == 0) {
+        state.time = simTime().dbl();
+        state.locations.assign(shared->locations, shared->locations + noOfLocs);
+        state.noOfNodesPresent = shared->noOfNodesPresent;
+        state.homes.resize(shared->noOfNodes);
+        state.states.resize(shared->noOfNodes);
+    }
+    state.homes[node] = homeCoord;
+    state.states[node].position = position;
+    state.states[node].target = targetPosition;
+    state.states[node].endTime = (nextChange >= simTime() ? nextChange.dbl() : simTime().dbl());
+    state.states[node].locId = destLocId;
+    state.states[node].waitNext = nextMoveIsWait;
+
+    // a move with its wait is saved as the move (followed by a wait)
+    // or as the wait, once arrived
+    if(segmentHasWait && simTime() < arrivalTime) {
+        state.states[node].endTime = arrivalTime.dbl();
+        state.states[node].waitNext = true;
+    }
 
-    return target;
+    // the last node writes the file (every node of it is filled, as no
+    // two hosts take the same one)
+    if(++shared->noOfSavedNodes == shared->noOfNodes && !state.write(saveStateFile.c_str())) {
+        throw cRuntimeError("SWIM :: Unable to write the state file '%s'", saveStateFile.c_str());
+    }
 }
 
-int SWIMMobility::updateNodesCount(Coord update, bool inc)
+void SWIMMobility::writeStats()
 {
-    bool inc_success = false;
-    bool dec_success = false;
-
-    Coord temp3;
-
-    // increment or decrement node counts based on the flag
-    for(int i = 0; i < noOfLocs; i++){
-        temp3.x = locations[i].myCoordX;
-        temp3.y = locations[i].myCoordY;
-        temp3.z = locations[i].myCoordZ;
-        if(inc == false && update == temp3) {
-            if(locations[i].noOfNodesPresent > 0) {
-                locations[i].noOfNodesPresent--;
-                dec_success = true;
-            }
-        }
-        if(inc == true && update == temp3){
-            locations[i].noOfNodesPresent++;
-            inc_success = true;
-        }
+#ifdef SWIM_STATS
+    SWIMStats &stats = shared->stats;
+
+    stats.addNode(getParentModule()->getFullPath(), counters);
+    if(++shared->noOfFinishedNodes < shared->noOfNodes) {
+        return;
     }
 
-    if(inc_success) {
-        return 1;
-    } else if(dec_success) {
-        return 2;
-    } else {
-        return 0;
+    // the last node closes the occupancy of the locations and writes all
+    stats.finishOccupancy(shared->noOfNodesPresent, simTime().dbl());
+    std::string jsonFile = statsFile + ".json";
+    std::string occupancyFile = statsFile + "-occupancy.csv";
+    if(!stats.writeJson(jsonFile.c_str()) || !stats.writeOccupancyCsv(occupancyFile.c_str())) {
+        throw cRuntimeError("SWIM :: Unable to write the statistics to '%s'", jsonFile.c_str());
+    }
+#endif
+}
+
+void SWIMMobility::findNodesAt(int locId, std::vector<SWIMMobility *> &found) const
+{
+    std::vector<SWIMModel *> members;
+
+    // all the nodes sharing the state of a simulation are SWIMMobility
+    // modules (the warm-up runs its nodes with a state of its own)
+    findMembers(locId, members);
+    found.clear();
+    for(SWIMModel *member : members) {
+        found.push_back(static_cast<SWIMMobility *>(member));
     }
 }
 
-void SWIMMobility::updateAllNodes(bool increase) {
-    int count = 0;
-
-    // get mobility modules of all nodes to compute node count
-    cSimulation *currentSimulation = getSimulation();
-    int maxID = currentSimulation->getLastComponentId();
-    for (int currentID = 0; currentID <= maxID; currentID++) {
-        cModule *currentModule = currentSimulation->getModule(currentID);
-        SWIMMobility *mobile = dynamic_cast<SWIMMobility*>(currentModule);
-        if (currentModule != NULL && mobile != NULL) {
-            mobile->updateNodesCount(neew, increase);
-            count++;
+void SWIMMobility::findNodesNear(int locId, double distance, std::vector<SWIMMobility *> &found) const
+{
+    std::vector<int> nearLocations;
+    std::vector<SWIMModel *> members;
+
+    found.clear();
+    if(locId < 0 || locId >= (int) shared->firstMembers.size() || shared->locations == nullptr) {
+        return;
+    }
+
+    // a node staying within the distance of the location is at most the
+    // radius away from the location it is counted at, so the members of
+    // the locations up to the distance and the radius away are checked
+    // (with their positions now, as those moving may be further away)
+    Coord location(shared->locations[locId].myCoordX, shared->locations[locId].myCoordY, shared->locations[locId].myCoordZ);
+    double squaredDistance = distance * distance;
+    findLocationsNear(location, distance + radius, nearLocations);
+
+    for(int nearLocId : nearLocations) {
+        findMembers(nearLocId, members);
+        for(SWIMModel *member : members) {
+            SWIMMobility *node = static_cast<SWIMMobility *>(member);
+            if((node->getCurrentPosition() - location).squareLength() <= squaredDistance) {
+                found.push_back(node);
+            }
         }
     }
 }
 
 SWIMMobility::~SWIMMobility() {
+
+    // a deleted node is no longer counted at its location (here, as the
+    // occupancy statistics take the time of the simulation), and leaves
+    // its members in the destructor of SWIMModel
+    if(shared && memberLocId >= 0) {
+        updateNodesCount(memberLocId, false);
+    }
+
+    // a deleted node no longer prepares its decisions
+    if(deciderSlot >= 0) {
+        shared->deciders[deciderSlot] = nullptr;
+    }
 }
 
 } // namespace inet
@@ -32,6 +32,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -39,67 +40,75 @@
 #include "inet/common/INETMath.h"
 #include "inet/common/INETDefs.h"
 #include "inet/mobility/base/LineSegmentsMobilityBase.h"
-
-struct loc {
-    int noOfNodesPresent;
-
-    double myCoordX;
-    double myCoordY;
-    double myCoordZ;
-};
-
-struct nodeProp {
-    int seen = 0;
-
-    double locCoordX;
-    double locCoordY;
-    double locCoordZ;
-    double weight = 0;
-};
-#ifndef PI
-#define PI 3.14159265
-#endif
-#define LOCATIONS_FILE          "locations.txt"
+#include "inet/mobility/single/SWIMModel.h"
 
 namespace inet {
 
-class INET_API SWIMMobility : public LineSegmentsMobilityBase
+/** Returns the state shared by the SWIM nodes of the given simulation (created by the first node) **/
+std::shared_ptr<swimShared> findSharedState(cSimulation *simulation);
+
+class INET_API SWIMMobility : public LineSegmentsMobilityBase, public SWIMModel
 {
 protected:
     bool created;
-    bool firstStep;
     bool nextMoveIsWait;
 
     int update;
-    int popularityDecisionThreshold;
-    int returnHomePercentage;
-    int dimensions;
 
-    double neighbourLocationLimit;
     double speed;
-    double alpha = 0.0;
-    double radius;
 
-    std::vector<loc> locations;
-    std::vector<nodeProp> neighborLocs;
-    std::vector<nodeProp> visitingLocs;
+    // the wait time (read once, unless an expression) and whether the wait
+    // at a target is taken in the same segment as the move to it
+    cPar *waitTimePar;
+    bool waitTimeIsExpression;
+    double waitTime;
+    bool mergeWaitAndMove;
+    bool segmentHasWait;
+
+    // the current segment, in which the node moves from moveStart until
+    // arrivalTime and then stays at the target until nextChange (the
+    // position at any time follows from it, so with lazy updates the
+    // node is only updated at the end of a segment)
+    bool lazyPositionUpdates;
+    Coord moveStart;
+    simtime_t moveStartTime;
+    simtime_t arrivalTime;
+
+    // threads to separate the locations of the nodes deciding at the same
+    // time on (1 for none), with the slot of the node in the shared state
+    int locationThreads;
+    int deciderSlot;
 
-    Coord neew;
     int usedRNG;
-    Coord homeCoord;
     bool recreateLocationsFile;
+    std::string locationsFileName;
+    std::string importLocationsFile;
+    std::string exportLocationsFile;
+
+    // replay mode, where the segments are read from a trace file
+    std::string replayTraceFile;
+    int replayNode;
+    traceCursor replayCursor;
+
+    // warm-up, after which the nodes start (at the index of the node
+    // in the homes of the shared state)
+    double warmUpTime;
+    int warmUpIndex;
+
+    // state file the nodes start from and the one they are saved to
+    // at the end of the simulation (the node is found by its index)
+    std::string restoreStateFile;
+    std::string saveStateFile;
+    int stateNode;
+    bool restorePending;
+
+    // files the statistics are written to (with SWIM_STATS only)
+    std::string statsFile;
 
 private:
     bool homeCoordFound;
 
 public:
-    int noOfLocs;
-    int nodes;
-
-    double maxAreaX;
-    double maxAreaY;
-    double maxAreaZ;
-
     int count = 0;
 
 protected:
@@ -109,32 +118,83 @@ protected:
 
     virtual void finish() override;
 
+    virtual void setInitialPosition() override;
+
+    virtual void initializePosition() override;
+
     virtual void setTargetPosition() override;
 
     virtual void move() override;
 
+    virtual double drawUniform(double a, double b) override;
+
+    virtual int drawIntUniform(int a, int b) override;
+
+    virtual void drawUniformBlock(double *numbers, int count) override;
+
+#ifdef SWIM_STATS
+    virtual double statsTime() override { return simTime().dbl(); }
+#endif
+
+    /** Returns the time to wait at the next target **/
+    double nextWaitTime();
+
+    /** Starts the segment given by setTargetPosition() and checks that it is within the constraint area **/
+    virtual void startSegment();
+
+    bool isInsideArea(const Coord &position) const;
+
     /** Create locations **/
     virtual bool createLocations();
 
-    /** Reads the locations from file **/
+    /** Maps the locations from file, if created with the same parameters **/
     virtual bool readLocations();
 
-    /** Separates the visiting and neighboring locations and updates their weights **/
-    virtual void seperateAndUpdateWeights();
+    /** Builds the header (parameter fingerprint) of the locations file **/
+    virtual void fillLocationsHeader(locHeader &header);
+
+    /** Whether the next decision separates the locations, unless the node goes home **/
+    bool needsLocations() const { return !nextMoveIsWait && !locationsPrepared && !(cacheLocationWeights && weightsCached); }
+
+    /** Queues the next decision of the node, when it is a move, for the nodes preparing their decisions at once **/
+    void queueDecision();
 
-    /** Decides whether neighbor or visiting locations is to be visited next **/
-    virtual Coord decision();
+    /** Separates the locations of all nodes deciding now on the threads, on the first decision at this time **/
+    virtual void prepareDecisions();
 
-    /** Chooses a random set of Coordinates from given array **/
-    virtual Coord chooseDestination(std::vector<nodeProp> &array);
+    /** Opens the trace file (if not yet) and finds the home and the segments of the node **/
+    virtual void startReplay();
 
-    /** Updates the number of nodes for given coordinates **/
-    virtual int updateNodesCount(Coord update, bool inc);
+    /** Takes the next segment of the node from the trace file **/
+    virtual void replayTargetPosition();
 
-    /** Used to update a common locations table in all of the nodes **/
-    virtual void updateAllNodes(bool increase);
+    /** Runs the warm-up of all nodes (if not yet) and starts the node in its state at the end of it **/
+    virtual void startAfterWarmUp();
+
+    /** Index of the node in a trace or state file (replayNodeIndex, or the index of the host in its vector) **/
+    virtual int findNodeIndex();
+
+    /** Marks the node of a file (of the given number of nodes) as taken by this host, where no two hosts may take the same node **/
+    virtual void claimNodeIndex(std::vector<bool> &taken, int node, int noOfFileNodes, const std::string &fileName);
+
+    /** Reads the state file (if not yet) and takes the locations and node counts from it **/
+    virtual void startRestore();
+
+    /** Adds the state of the node to the saved state and writes it once all nodes are in **/
+    virtual void saveState();
+
+    /** Adds the counters of the node to the statistics and writes them once all nodes are in **/
+    virtual void writeStats();
 
 public:
+    /** Finds the nodes at or heading to a location (e.g., for neighbour discovery among them only) **/
+    virtual void findNodesAt(int locId, std::vector<SWIMMobility *> &found) const;
+
+    /** Finds the nodes within the given distance of a location now, among the nodes at or heading to the locations
+        up to the distance (and the radius) away from it, so nodes at or heading home and those passing on their
+        way to a location further away are not found **/
+    virtual void findNodesNear(int locId, double distance, std::vector<SWIMMobility *> &found) const;
+
     /** Constructor **/
     SWIMMobility();
 
@@ -0,0 +1,1185 @@
+/******************************************************************************
+ * SWIMMobility - A SWIM implementation for the INET Framework of the OMNeT++
+ * Simulator.
+ *
+ * Copyright (C) 2016, Sustainable Communication Networks, University of Bremen, Germany
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ *
+ ******************************************************************************/
+
+/**
+ * The C++ implementation file of the SWIM model logic of one node.
+ *
+ * @author : Anas bin Muslim (anas1@uni-bremen.de)
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "inet/mobility/single/SWIMModel.h"
+
+namespace inet{
+
+void locationGrid::build(const float *x, const float *y, int count, double cellSize)
+{
+    double minX = 0.0, maxX = 0.0, minY = 0.0, maxY = 0.0;
+
+    for(int i = 0; i < count; i++) {
+        minX = (i == 0 || x[i] < minX ? x[i] : minX);
+        maxX = (i == 0 || x[i] > maxX ? x[i] : maxX);
+        minY = (i == 0 || y[i] < minY ? y[i] : minY);
+        maxY = (i == 0 || y[i] > maxY ? y[i] : maxY);
+    }
+
+    // cells of the given size, but not many more cells than locations
+    double width = maxX - minX;
+    double height = maxY - minY;
+    if(cellSize <= 0.0) {
+        cellSize = 1.0;
+    }
+    if((width / cellSize + 1.0) * (height / cellSize + 1.0) > 2.0 * count + 1.0) {
+        cellSize = std::max(cellSize, sqrt(width * height / (2.0 * count)));
+    }
+
+    this->cellSize = cellSize;
+    originX = minX;
+    originY = minY;
+    cellsX = (int) (width / cellSize) + 1;
+    cellsY = (int) (height / cellSize) + 1;
+
+    // sort the locations by cell, keeping the order of their ids
+    std::vector<int> cells(count);
+    cellStarts.assign(cellsX * cellsY + 1, 0);
+    for(int i = 0; i < count; i++) {
+        int cellX = std::min((int) ((x[i] - originX) / cellSize), cellsX - 1);
+        int cellY = std::min((int) ((y[i] - originY) / cellSize), cellsY - 1);
+        cells[i] = cellY * cellsX + cellX;
+        cellStarts[cells[i] + 1]++;
+    }
+    for(int c = 0; c < cellsX * cellsY; c++) {
+        cellStarts[c + 1] += cellStarts[c];
+    }
+    std::vector<int> next(cellStarts.begin(), cellStarts.end() - 1);
+    cellLocations.resize(count);
+    for(int i = 0; i < count; i++) {
+        cellLocations[next[cells[i]]++] = i;
+    }
+}
+
+template<int dims>
+void locationGrid::query(const float *x, const float *y, const float *z, double positionX, double positionY, double positionZ,
+        double distance, std::vector<int> &found) const
+{
+    found.clear();
+    if(!isBuilt()) {
+        return;
+    }
+
+    int fromX = std::max((int) floor((positionX - distance - originX) / cellSize), 0);
+    int toX = std::min((int) floor((positionX + distance - originX) / cellSize), cellsX - 1);
+    int fromY = std::max((int) floor((positionY - distance - originY) / cellSize), 0);
+    int toY = std::min((int) floor((positionY + distance - originY) / cellSize), cellsY - 1);
+
+    // check the locations of the cells around the position with the
+    // same computation as the kernels, so that the result is the same
+    for(int cellY = fromY; cellY <= toY; cellY++) {
+        for(int cellX = fromX; cellX <= toX; cellX++) {
+            int cell = cellY * cellsX + cellX;
+            for(int i = cellStarts[cell]; i < cellStarts[cell + 1]; i++) {
+                int locId = cellLocations[i];
+                if(swimLocationDistance<dims>(x, y, z, locId, positionX, positionY, positionZ) <= distance) {
+                    found.push_back(locId);
+                }
+            }
+        }
+    }
+    std::sort(found.begin(), found.end());
+}
+
+void swimShared::reset(int noOfLocs, int dimensions)
+{
+    locations = locationsFile.getLocations();
+
+    // created locations have integer coordinates, which floats hold exactly
+    locationsX.resize(noOfLocs);
+    locationsY.resize(noOfLocs);
+    for(int i = 0; i < noOfLocs; i++) {
+        locationsX[i] = locations[i].myCoordX;
+        locationsY[i] = locations[i].myCoordY;
+    }
+
+    // in 2 dimensions, all locations are at z = 0
+    if(dimensions == 3) {
+        locationsZ.resize(noOfLocs);
+        for(int i = 0; i < noOfLocs; i++) {
+            locationsZ[i] = locations[i].myCoordZ;
+        }
+    } else {
+        std::vector<float>().swap(locationsZ);
+    }
+
+    // the grid is built for these locations when first needed
+    locationIndex = locationGrid();
+    resetCounts(noOfLocs);
+}
+
+void swimShared::resetCounts(int noOfLocs)
+{
+    noOfNodesPresent.assign(noOfLocs, 0);
+    locationChanges.assign(noOfLocs, 0);
+    locationChangeCount = 0;
+
+    crowdedLocations.clear();
+    crowdedSlots.assign(noOfLocs, -1);
+    trackCrowded(minCrowdedSeen);
+
+    occupancyChanges.assign(noOfLocs, 0);
+    changedLocations.clear();
+
+    firstMembers.assign(noOfLocs, nullptr);
+
+#ifdef SWIM_STATS
+    stats.reset(noOfLocs);
+#endif
+}
+
+void swimShared::noteChange(int locId)
+{
+    int noOfLocs = noOfNodesPresent.size();
+
+    // remember the change for nodes with cached weights
+    locationChanges[locationChangeCount % noOfLocs] = locId;
+    locationChangeCount++;
+
+    // keep the list of crowded locations once used
+    if(minCrowdedSeen >= 0) {
+        bool crowded = (noOfNodesPresent[locId] >= minCrowdedSeen);
+        int slot = crowdedSlots[locId];
+        if(crowded && slot < 0) {
+            crowdedSlots[locId] = crowdedLocations.size();
+            crowdedLocations.push_back(locId);
+        } else if(!crowded && slot >= 0) {
+            int last = crowdedLocations.back();
+            crowdedLocations[slot] = last;
+            crowdedSlots[last] = slot;
+            crowdedLocations.pop_back();
+            crowdedSlots[locId] = -1;
+        }
+    }
+}
+
+void swimShared::applyOccupancyChanges(const std::vector<int> &locIds, const std::vector<int> &changes)
+{
+    // the nodes of a partition leave a location only after arriving there,
+    // and the partitions send their changes in order, so no count drops
+    // below the nodes present in this partition
+    for(size_t i = 0; i < locIds.size() && i < changes.size(); i++) {
+        int locId = locIds[i];
+        if(locId < 0 || locId >= (int) noOfNodesPresent.size() || changes[i] == 0) {
+            continue;
+        }
+        noOfNodesPresent[locId] += changes[i];
+        noteChange(locId);
+    }
+}
+
+void swimShared::trackCrowded(int minCrowded)
+{
+    if(minCrowded < 0 || (minCrowdedSeen >= 0 && minCrowded > minCrowdedSeen)) {
+        return;
+    }
+
+    // with a lower number of nodes, more locations are crowded (and the
+    // counts may have changed while no list was kept)
+    minCrowdedSeen = minCrowded;
+    crowdedLocations.clear();
+    crowdedSlots.assign(noOfNodesPresent.size(), -1);
+    for(int locId = 0; locId < (int) noOfNodesPresent.size(); locId++) {
+        if(noOfNodesPresent[locId] >= minCrowdedSeen) {
+            crowdedSlots[locId] = crowdedLocations.size();
+            crowdedLocations.push_back(locId);
+        }
+    }
+}
+
+void weightTree::reset(const std::vector<double> &values)
+{
+    int size = values.size();
+
+    weights = values;
+    sums.assign(size + 1, 0.0);
+    sum = 0.0;
+    for(int i = 0; i < size; i++) {
+        sum += values[i];
+        sums[i + 1] += values[i];
+
+        // pass the sum on to the parent entry
+        int parent = (i + 1) + ((i + 1) & -(i + 1));
+        if(parent <= size) {
+            sums[parent] += sums[i + 1];
+        }
+    }
+}
+
+void weightTree::set(int index, double weight)
+{
+    double delta = weight - weights[index];
+
+    weights[index] = weight;
+    sum += delta;
+    for(int i = index + 1; i < (int) sums.size(); i += i & -i) {
+        sums[i] += delta;
+    }
+}
+
+int weightTree::find(double value) const
+{
+    int size = weights.size();
+    int position = 0;
+    int step = 1;
+
+    while(step * 2 <= size) {
+        step *= 2;
+    }
+
+    // descend the tree, skipping every part whose sum is not above the value
+    for(; step > 0; step /= 2) {
+        if(position + step <= size && sums[position + step] <= value) {
+            position += step;
+            value -= sums[position];
+        }
+    }
+
+    return std::min(position, size - 1);
+}
+
+SWIMModel::SWIMModel()
+{
+    firstStep = true;
+    destLocId = -1;
+    weightsCached = false;
+    lastChangeSeen = 0;
+    minPopularFrom = INT32_MAX;
+    popularNeighbors = 0;
+    popularVisiting = 0;
+    twoDimensional = false;
+    distancesKernel = swimLocationDistances<3>;
+    weightedSelection = false;
+    fastDiscSampling = false;
+    batchedRandomNumbers = false;
+    nextRandom = 0;
+    nextDisc = 0;
+    implicitVisiting = false;
+    visitingImplicit = false;
+    minCrowdedSeen = -1;
+    locationsPrepared = false;
+    memberLocId = -1;
+    previousMember = nullptr;
+    nextMember = nullptr;
+}
+
+void SWIMModel::setupModel()
+{
+    firstStep = true;
+    destLocId = -1;
+    weightsCached = false;
+    locationsPrepared = false;
+    lastChangeSeen = 0;
+    popularNeighbors = 0;
+    popularVisiting = 0;
+
+    // radius should never be zero
+    if(radius == 0) {
+        radius = 1;
+    }
+
+    // blocks are drawn at the first decision
+    if(batchedRandomNumbers) {
+        randomBlock.assign(RANDOM_BLOCK, 0.0);
+        discBlock.assign(2 * DISC_BLOCK, 0.0);
+    } else {
+        randomBlock.clear();
+        discBlock.clear();
+    }
+    nextRandom = RANDOM_BLOCK;
+    nextDisc = DISC_BLOCK;
+
+    // the distances are computed in the dimensions of the locations
+    twoDimensional = (dimensions != 3);
+    distancesKernel = (twoDimensional ? swimLocationDistances<2> : swimLocationDistances<3>);
+
+    // compute the maximum possible weight (to normalize)
+    double diagonal = sqrt( pow(maxAreaX, 2.0) + pow(maxAreaY, 2.0) + (twoDimensional ? 0.0 : pow(maxAreaZ, 2.0)));
+    maxWeight = alpha * diagonal + (1.0 - alpha) * nodes;
+
+    // as no location is further than the diagonal, a location can only be
+    // popular once enough nodes are present (unless the distance alone
+    // may make it popular, where visiting locations cannot be implicit)
+    visitingImplicit = false;
+    neighborSlots.clear();
+    auto couldBePopular = [&](int64_t seen) { return (alpha * diagonal + (1.0 - alpha) * seen) / maxWeight > POPULAR_WEIGHT; };
+    if(couldBePopular(0)) {
+        minCrowdedSeen = -1;
+    } else if(!couldBePopular(INT32_MAX)) {
+        minCrowdedSeen = INT32_MAX;
+    } else {
+        int64_t low = 1, high = INT32_MAX;
+        while(low < high) {
+            int64_t middle = (low + high) / 2;
+            if(couldBePopular(middle)) {
+                high = middle;
+            } else {
+                low = middle + 1;
+            }
+        }
+        minCrowdedSeen = low;
+    }
+}
+
+bool SWIMModel::generateLocations(std::vector<loc> &locs)
+{
+    // other layouts (and separated locations) are created in chunks by
+    // the location generator, seeded from the RNG used for SWIM
+    if(locationLayout.layout != LAYOUT_UNIFORM || locationLayout.minSeparation > 0.0) {
+        uint64_t seed = (uint64_t) drawIntUniform(0, INT32_MAX - 1);
+        SWIMLocationGenerator generator(locationLayout, noOfLocs, dimensions, maxAreaX, maxAreaY, maxAreaZ, radius * 2.0, seed);
+        return generator.generate(locs);
+    }
+
+    locs.resize(noOfLocs);
+
+    // creation of locations assume the following based
+    // on the mobility area
+    // 1) constraint area must be > 0
+    // 2) constraint area must be at least > 2 times the value
+    //    defined in radius because locations are not created
+    //    at the borders
+    if (noOfLocs > 0 && !(maxAreaX > (radius * 4.0) && maxAreaY > (radius * 4.0))) {
+        return false;
+    }
+
+    // create a set of random locations in the mobility area
+    for(int i = 0; i < noOfLocs; i++) {
+
+        // compute random x coord
+        // locs[i].myCoordX = (double) intuniform(0, ((int)round(maxAreaX) - 10), usedRNG);
+        double coordElem = drawUniform((radius * 2.0), (maxAreaX - (radius * 2.0)));
+        locs[i].myCoordX = (int) coordElem;
+
+        // compute random y coord
+        // locs[i].myCoordY = (double) intuniform(0, ((int)round(maxAreaY) - 10), usedRNG);
+        coordElem = drawUniform((radius * 2.0), (maxAreaY - (radius * 2.0)));
+        locs[i].myCoordY = (int) coordElem;
+
+        // z coord is always 0
+        if(dimensions == 3){
+            coordElem = drawUniform((radius * 2.0), (maxAreaZ - (radius * 2.0)));
+            locs[i].myCoordZ = (int) coordElem;
+        } else {
+            locs[i].myCoordZ = 0.0;
+        }
+    }
+
+    return true;
+}
+
+Coord SWIMModel::nextTargetPosition(const Coord &lastPosition)
+{
+    Coord targetPosition;
+    double randomNum = nextUniform(0.0, 1.0);
+    double returnHomeDecimalFraction = returnHomePercentage / 100.0;
+
+    // randomly base to where the next move will be; home or
+    // other location (neighboring or visiting), provided that
+    // node is not already at home location
+    if(randomNum < returnHomeDecimalFraction && lastPosition != homeCoord) {
+
+        if(!firstStep) {
+            updateAllNodes(false);
+        }
+
+        // home is not one of the locations
+        destLocId = -1;
+        SWIM_STATS_COUNT(homeReturns);
+
+        // select home location to move to
+        targetPosition = homeCoord;
+
+    } else {
+
+        // select the neighbouring or visiting location to move to
+
+        // compute the weights assignd to each node
+        seperateAndUpdateWeights();
+
+        // update the seen count (i.e., decrement nodes), but not at the begining
+        // as locations have not seen any nodes yet
+        if(!firstStep) {
+            updateAllNodes(false);
+        }
+
+        // find the next location (position) to move to
+        targetPosition = decision();
+
+        // update the seen count (i.e., increment nodes)
+        updateAllNodes(true);
+    }
+
+    // indicate first time actions are all done
+    firstStep = false;
+
+    return targetPosition;
+}
+
+void SWIMModel::seperateAndUpdateWeights()
+{
+    SWIM_STATS_TIMER(SWIM_TIMER_SEPERATE);
+
+    // the separation and the distance part of the weights depend only
+    // on the home location, so when cached, only the weights of the
+    // locations that saw node count changes are updated
+    if(cacheLocationWeights && weightsCached) {
+        refreshWeights();
+        return;
+    }
+
+    if(!locationsPrepared) {
+        prepareLocations();
+    }
+    locationsPrepared = false;
+
+    partitionLocations();
+
+    if(cacheLocationWeights) {
+        lastChangeSeen = shared->locationChangeCount;
+        weightsCached = true;
+    }
+}
+
+void SWIMModel::prepareLocations()
+{
+    static thread_local std::vector<double> distances, distTerms;
+    static thread_local std::vector<int> popularFrom;
+    int noOfNeighbors = 0, n = 0, v = 0;
+
+    // leave the visiting locations implicit, when possible
+    visitingImplicit = false;
+    locationsPrepared = true;
+    if(implicitVisiting && minCrowdedSeen >= 0 && !weightedSelection && seperateNeighbors()) {
+        return;
+    }
+
+    // compute the distances of all the locations at once, and from them
+    // the distance terms of the weights and the counts of nodes present
+    // from which the locations are popular
+    distances.resize(noOfLocs);
+    distTerms.resize(noOfLocs);
+    popularFrom.resize(noOfLocs);
+    distancesKernel(shared->locationsX.data(), shared->locationsY.data(), shared->locationsZ.data(), noOfLocs,
+            homeCoord.x, homeCoord.y, homeCoord.z, distances.data());
+    swimPopularCounts(distances.data(), noOfLocs, alpha, maxWeight, POPULAR_WEIGHT, distTerms.data(), popularFrom.data());
+
+    // compute how many neighboring locations exist
+    minPopularFrom = INT32_MAX;
+    for(int i = 0; i < noOfLocs; i++) {
+        if(distances[i] <= neighbourLocationLimit){
+            noOfNeighbors++;
+        }
+    }
+
+    // adjust arrays to hold the neighboring and visiting locations
+    neighborLocs.resize((noOfNeighbors));
+    visitingLocs.resize((noOfLocs - noOfNeighbors));
+
+
+    // separate the locations into neighboring and visiting locations
+    for(int i = 0; i < noOfLocs; i++) {
+        nodeProp &prop = (distances[i] <= neighbourLocationLimit ? neighborLocs[n++] : visitingLocs[v++]);
+        prop.locId = i;
+        prop.distTerm = distTerms[i];
+        prop.popularFrom = popularFrom[i];
+        minPopularFrom = std::min(minPopularFrom, prop.popularFrom);
+    }
+}
+
+void SWIMModel::refreshWeights()
+{
+    int64_t pending = shared->locationChangeCount - lastChangeSeen;
+
+    // if more locations changed than are remembered, only the popular
+    // and crowded locations can have changed sides, or else partition
+    // all of them again (still cheaper than recomputing the distances),
+    // which with implicit visiting locations is cheaper once more
+    // changed than there are neighbouring locations
+    if(pending >= noOfLocs) {
+        if(!refreshCrowdedLocations()) {
+            partitionLocations();
+        }
+    } else if(visitingImplicit && pending >= (int64_t) neighborLocs.size()) {
+        partitionLocations();
+
+    // otherwise, update only the locations changed since the last refresh
+    } else {
+        for(int64_t change = lastChangeSeen; change < shared->locationChangeCount; change++) {
+            int slot = findLocSlot(shared->locationChanges[change % noOfLocs]);
+            if(slot == NO_SLOT) {
+                continue;
+            } else if(slot >= 0) {
+                updateWeight(neighborLocs, popularNeighbors, slot);
+            } else {
+                updateWeight(visitingLocs, popularVisiting, -slot - 1);
+            }
+        }
+    }
+
+    lastChangeSeen = shared->locationChangeCount;
+}
+
+bool SWIMModel::refreshCrowdedLocations()
+{
+    // the weights of all the changed locations are needed for weighted
+    // selection, and the crowded locations must include all that can be
+    // popular for this node (and be fewer than all the locations)
+    int crowded = shared->crowdedLocations.size();
+    if(weightedSelection || visitingImplicit || shared->minCrowdedSeen < 0 || shared->minCrowdedSeen > minPopularFrom
+            || popularNeighbors + popularVisiting + crowded >= noOfLocs) {
+        return false;
+    }
+
+    // the popular locations that are no longer popular leave the front,
+    // from the back of it (where those moved back are already checked)
+    for(int n = popularNeighbors - 1; n >= 0; n--) {
+        updateWeight(neighborLocs, popularNeighbors, n);
+    }
+    for(int v = popularVisiting - 1; v >= 0; v--) {
+        updateWeight(visitingLocs, popularVisiting, v);
+    }
+
+    // and the crowded locations that became popular join it
+    for(int i = 0; i < crowded; i++) {
+        int slot = locSlots[shared->crowdedLocations[i]];
+        if(slot >= 0) {
+            updateWeight(neighborLocs, popularNeighbors, slot);
+        } else {
+            updateWeight(visitingLocs, popularVisiting, -slot - 1);
+        }
+    }
+
+    return true;
+}
+
+void SWIMModel::mapLocationSlots()
+{
+    neighborSlots.clear();
+
+    // implicit visiting locations have no slot
+    if(visitingImplicit) {
+        locSlots.clear();
+        for(int n = 0; n < (int) neighborLocs.size(); n++) {
+            neighborSlots[neighborLocs[n].locId] = n;
+        }
+        return;
+    }
+
+    locSlots.resize(noOfLocs);
+    for(int n = 0; n < (int) neighborLocs.size(); n++) {
+        locSlots[neighborLocs[n].locId] = n;
+    }
+    for(int v = 0; v < (int) visitingLocs.size(); v++) {
+        locSlots[visitingLocs[v].locId] = -v - 1;
+    }
+}
+
+void SWIMModel::partitionLocations()
+{
+    // only the split between popular and not popular locations is
+    // used when choosing a destination, so no full ordering is needed;
+    // once the slots are mapped, few locations change sides, so only
+    // the slots of those are updated
+    bool slotsMapped = (cacheLocationWeights && weightsCached);
+    popularNeighbors = partitionList(neighborLocs, true, slotsMapped);
+    popularVisiting = partitionList(visitingLocs, false, slotsMapped);
+
+    if(weightedSelection) {
+        static thread_local std::vector<double> weights;
+        weights.resize(neighborLocs.size());
+        for(int n = 0; n < (int) neighborLocs.size(); n++) {
+            weights[n] = weightOf(neighborLocs[n]);
+        }
+        neighborTree.reset(weights);
+        weights.resize(visitingLocs.size());
+        for(int v = 0; v < (int) visitingLocs.size(); v++) {
+            weights[v] = weightOf(visitingLocs[v]);
+        }
+        visitingTree.reset(weights);
+    }
+
+    if(cacheLocationWeights && !slotsMapped) {
+        mapLocationSlots();
+    }
+}
+
+int SWIMModel::partitionList(std::vector<nodeProp> &array, bool neighbors, bool slotsMapped)
+{
+    int first = 0;
+    int last = array.size();
+
+    while(true) {
+        while(first != last && isPopular(array[first])) {
+            first++;
+        }
+        if(first == last) {
+            return first;
+        }
+        last--;
+        while(first != last && !isPopular(array[last])) {
+            last--;
+        }
+        if(first == last) {
+            return first;
+        }
+
+        std::swap(array[first], array[last]);
+        if(slotsMapped) {
+            setLocSlot(array[first].locId, neighbors ? first : -first - 1);
+            setLocSlot(array[last].locId, neighbors ? last : -last - 1);
+        }
+        first++;
+    }
+}
+
+void SWIMModel::prepareLocationsOf(const std::vector<SWIMModel *> &nodes, int threads)
+{
+    // the separation depends only on the homes and locations and draws
+    // no random numbers, so the nodes decide afterwards (one by one, in
+    // the same order) exactly as without threads; a few nodes are not
+    // worth starting threads for
+    threads = std::min(threads, (int) nodes.size() / 4);
+    if(threads < 2) {
+        return;
+    }
+
+    std::atomic<int> nextNode(0);
+    std::vector<std::thread> workers;
+    for(int t = 0; t < threads; t++) {
+        workers.emplace_back([&]() {
+            for(int i = nextNode++; i < (int) nodes.size(); i = nextNode++) {
+                nodes[i]->prepareLocations();
+            }
+        });
+    }
+    for(std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+int SWIMModel::popularCount(double distTerm) const
+{
+    return swimPopularCount(distTerm, alpha, maxWeight, POPULAR_WEIGHT);
+}
+
+void SWIMModel::updateWeight(std::vector<nodeProp> &array, int &popular, int index)
+{
+    int other = -1;
+    bool isNowPopular = isPopular(array[index]);
+    weightTree &tree = (&array == &neighborLocs ? neighborTree : visitingTree);
+    if(weightedSelection) {
+        tree.set(index, weightOf(array[index]));
+    }
+
+    // if the location became popular (or not popular), swap it with the
+    // location at the border and move the border by one
+    if(isNowPopular && index >= popular) {
+        other = popular;
+        popular++;
+    } else if(!isNowPopular && index < popular) {
+        popular--;
+        other = popular;
+    }
+    if(other < 0 || other == index) {
+        return;
+    }
+
+    std::swap(array[index], array[other]);
+    if(weightedSelection) {
+        tree.set(index, weightOf(array[index]));
+        tree.set(other, weightOf(array[other]));
+    }
+    if(&array == &neighborLocs) {
+        setLocSlot(array[index].locId, index);
+        setLocSlot(array[other].locId, other);
+    } else {
+        setLocSlot(array[index].locId, -index - 1);
+        setLocSlot(array[other].locId, -other - 1);
+    }
+}
+
+int SWIMModel::findLocSlot(int locId) const
+{
+    if(visitingImplicit) {
+        auto slot = neighborSlots.find(locId);
+        return (slot != neighborSlots.end() ? slot->second : NO_SLOT);
+    }
+    return locSlots[locId];
+}
+
+void SWIMModel::setLocSlot(int locId, int slot)
+{
+    if(visitingImplicit) {
+        neighborSlots[locId] = slot;
+    } else {
+        locSlots[locId] = slot;
+    }
+}
+
+double SWIMModel::locationWeight(int locId) const
+{
+    double distTerm = alpha * locationDistance(locId);
+    return (distTerm + (1.0 - alpha) * shared->noOfNodesPresent[locId]) / maxWeight;
+}
+
+double SWIMModel::weightOf(const nodeProp &prop) const
+{
+    return (prop.distTerm + (1.0 - alpha) * shared->noOfNodesPresent[prop.locId]) / maxWeight;
+}
+
+void SWIMModel::findLocationsNear(const Coord &position, double distance, std::vector<int> &found) const
+{
+    // the grid is built by the first node that needs it
+    {
+        std::lock_guard<std::mutex> lock(shared->locationIndexMutex);
+        if(!shared->locationIndex.isBuilt()) {
+            shared->locationIndex.build(shared->locationsX.data(), shared->locationsY.data(), noOfLocs, neighbourLocationLimit);
+        }
+    }
+    if(twoDimensional) {
+        shared->locationIndex.query<2>(shared->locationsX.data(), shared->locationsY.data(), nullptr,
+                position.x, position.y, 0.0, distance, found);
+    } else {
+        shared->locationIndex.query<3>(shared->locationsX.data(), shared->locationsY.data(), shared->locationsZ.data(),
+                position.x, position.y, position.z, distance, found);
+    }
+}
+
+bool SWIMModel::seperateNeighbors()
+{
+    static thread_local std::vector<int> found;
+
+    findLocationsNear(homeCoord, neighbourLocationLimit, found);
+
+    // with most locations neighbouring, drawing a visiting location
+    // from all the locations would take too many tries
+    if(2 * (int) found.size() > noOfLocs) {
+        return false;
+    }
+
+    visitingImplicit = true;
+    neighborLocs.resize(found.size());
+    for(int n = 0; n < (int) found.size(); n++) {
+        int i = found[n];
+        nodeProp &prop = neighborLocs[n];
+        prop.locId = i;
+        prop.distTerm = alpha * locationDistance(i);
+        prop.popularFrom = popularCount(prop.distTerm);
+    }
+    visitingLocs.clear();
+
+    return true;
+}
+
+// make the decision of which location to go to next
+Coord SWIMModel::decision()
+{
+    Coord dest;
+    SWIM_STATS_TIMER(SWIM_TIMER_DECISION);
+
+    // the neighbor & visiting locations lists are already partitioned
+    // into popular and not popular locations by seperateAndUpdateWeights()
+
+    // the procedure of identifying the next location is as follows
+    // 1) decide randomly what type of location to go to next (neighboring or visiting)
+    //    using the alpha parameter
+    //    if alpha is lower, more likely to choose a visisting location
+    //    if alpha is larger, more likely to choose a neighbouring location
+    // 2) call chooseDestination() to select the destination to go to
+    // 3) if there are no locations selected by chooseDestination() based on
+    //    the given list (i.e., neighboring or visiting), check in the other
+    //    list (i.e., visiting or neighbouring)
+
+    // get random number between 0 & 1 (included)
+    double randomNumber = nextUniform(0.0, 1.0);
+    if (randomNumber <= alpha) {
+
+        // if random number is lowr than alpha, choose a neighbor location as
+        // next destination
+        dest = chooseDestination(neighborLocs, popularNeighbors);
+
+        // must be a valid destination
+        if(destLocId >= 0) {
+            SWIM_STATS_PICK(true);
+            return dest;
+
+            // if there was a invalid destination, choose visiting location
+            // as next destination (NL 0 0 0)
+        } else {
+            SWIM_STATS_COUNT(fallbacks);
+            dest = chooseDestination(visitingLocs, popularVisiting);
+            SWIM_STATS_PICK(false);
+            return dest;
+        }
+
+    } else {
+
+        // if random number is lowr than alpha, choose a visiting location as
+        // next destination
+        dest  = chooseDestination(visitingLocs, popularVisiting);
+        if (destLocId >= 0) {
+            SWIM_STATS_PICK(false);
+            return dest;
+
+            // if there was a invalid destination, choose neighbor location
+            // as next destination (VL 0 0 0)
+        } else {
+            SWIM_STATS_COUNT(fallbacks);
+            dest = chooseDestination(neighborLocs, popularNeighbors);
+            SWIM_STATS_PICK(true);
+            return dest;
+        }
+    }
+}
+
+// select a destination randomly from the given aray (i.e., neighboring
+// locations array or visiting locations array)
+Coord SWIMModel::chooseDestination(std::vector<nodeProp> &array, int popular)
+{
+    int size = array.size();
+    int randomNum = 0;
+    int notPopular = 0;
+
+    Coord temp;
+    Coord target;
+
+    // implicit visiting locations are chosen without a list
+    if(visitingImplicit && &array == &visitingLocs) {
+        return chooseVisitingDestination();
+    }
+
+    // if array has no elements, then return
+    if (size == 0) {
+        destLocId = -1;
+        temp.x = 0.0;
+        temp.y = 0.0;
+        temp.z = 0.0;
+        return temp;
+    }
+
+    // compute the not-popular locations (popular locations
+    // are at the front of the array)
+    notPopular = size - popular;
+
+    // choose a destination from the given array in the following manner
+    // 1) obtain a random number and check if a popular or not popular
+    //    item is selected (i.e., popularityDecisionThreshold)
+    // 2) if popular item to be selected and the popular range has items,
+    //    select an item in the popular range, randomly
+    // 3) if not popular to be selected and the not popular range has items,
+    //    select an item in the not popular range, randomly
+    // 4) if none of the above, select an item from the whole array,
+    //    randomly
+
+    // or, for weighted selection, draw a location in proportion to its
+    // weight (uniformly, if all the weights are zero)
+    if(weightedSelection) {
+        weightTree &tree = (&array == &neighborLocs ? neighborTree : visitingTree);
+        if(tree.sum > 0.0) {
+            randomNum = tree.find(nextUniform(0.0, tree.sum));
+        } else {
+            randomNum = nextIntUniform(0, (size - 1));
+        }
+
+    } else {
+        randomNum = nextIntUniform(0, 10);
+        if(popular > 0 && randomNum > (10 - popularityDecisionThreshold)) {
+            randomNum = nextIntUniform(0, (popular - 1));
+
+        } else if (notPopular > 0) {
+            randomNum = popular + nextIntUniform(0, (notPopular - 1));
+
+        } else {
+            randomNum = nextIntUniform(0, (size - 1));
+
+        }
+    }
+    const loc &chosen = shared->locations[array[randomNum].locId];
+    temp.x = chosen.myCoordX;
+    temp.y = chosen.myCoordY;
+    temp.z = chosen.myCoordZ;
+
+    // find a position within the radius given from the selected location
+    // to move to
+    // REASON: don't want all the nodes to pile up at the center of the
+    // location
+    Coord offset = drawDiscOffset();
+
+    target.x = temp.x + offset.x;
+    target.y = temp.y + offset.y;
+    target.z = temp.z;
+
+    // temporary code to place node at the center of the location
+    // and not to spread inside the radius.
+    //target = temp;
+
+    // save location for node count computation
+    destLocId = array[randomNum].locId;
+
+    return target;
+}
+
+Coord SWIMModel::chooseVisitingDestination()
+{
+    static thread_local std::vector<int> popularLocs;
+    int size = noOfLocs - neighborLocs.size();
+    int randomNum = 0;
+    int locId = -1;
+    Coord target;
+
+    if(size == 0) {
+        destLocId = -1;
+        return target;
+    }
+
+    // only crowded locations can be popular
+    popularLocs.clear();
+    for(int crowded : shared->crowdedLocations) {
+        if(locationDistance(crowded) > neighbourLocationLimit && locationWeight(crowded) > POPULAR_WEIGHT) {
+            popularLocs.push_back(crowded);
+        }
+    }
+    int popular = popularLocs.size();
+    int notPopular = size - popular;
+
+    // choose as chooseDestination() does, where a not popular location is
+    // drawn from all the locations until a visiting one that is not
+    // popular comes up (in about two tries, as at least half of the
+    // locations are visiting and few are popular)
+    randomNum = nextIntUniform(0, 10);
+    if(popular > 0 && randomNum > (10 - popularityDecisionThreshold)) {
+        locId = popularLocs[nextIntUniform(0, (popular - 1))];
+
+    } else if(notPopular > 0) {
+        do {
+            locId = nextIntUniform(0, (noOfLocs - 1));
+        } while(locationDistance(locId) <= neighbourLocationLimit
+                || (shared->crowdedSlots[locId] >= 0 && locationWeight(locId) > POPULAR_WEIGHT));
+
+    } else {
+        locId = popularLocs[nextIntUniform(0, (popular - 1))];
+    }
+
+    Coord offset = drawDiscOffset();
+    target.x = shared->locations[locId].myCoordX + offset.x;
+    target.y = shared->locations[locId].myCoordY + offset.y;
+    target.z = shared->locations[locId].myCoordZ;
+
+    destLocId = locId;
+    return target;
+}
+
+Coord SWIMModel::drawDiscOffset()
+{
+    Coord offset;
+    double u, v, w, t;
+
+    // points of the enclosing square are drawn until one is in the
+    // disc (1.27 tries on average), which needs no sqrt, cos or sin
+    if(fastDiscSampling) {
+        do {
+            u = nextUniform(-1.0, 1.0);
+            v = nextUniform(-1.0, 1.0);
+        } while(u * u + v * v > 1.0);
+
+        offset.x = radius * u;
+        offset.y = radius * v;
+        return offset;
+    }
+
+    // or taken from a block of positions computed at once
+    if(batchedRandomNumbers) {
+        if(nextDisc == DISC_BLOCK) {
+            double numbers[2 * DISC_BLOCK];
+            drawUniformBlock(numbers, 2 * DISC_BLOCK);
+            swimDiscOffsets(numbers, numbers + DISC_BLOCK, DISC_BLOCK, radius, discBlock.data(), discBlock.data() + DISC_BLOCK);
+            nextDisc = 0;
+        }
+        offset.x = discBlock[nextDisc];
+        offset.y = discBlock[DISC_BLOCK + nextDisc];
+        nextDisc++;
+        return offset;
+    }
+
+    u = drawUniform(0, 1);
+    v = drawUniform(0, 1);
+    w = radius * sqrt(u);
+    t = 2 * PI * v;
+    offset.x = w * cos(t);
+    offset.y = w * sin(t);
+
+    return offset;
+}
+
+int SWIMModel::updateNodesCount(int locId, bool inc)
+{
+    bool inc_success = false;
+    bool dec_success = false;
+
+    // not at one of the locations (e.g., home)
+    if(locId < 0 || locId >= noOfLocs) {
+        return 0;
+    }
+
+    // increment or decrement node counts based on the flag
+    if(inc == false) {
+        if(shared->noOfNodesPresent[locId] > 0) {
+            shared->noOfNodesPresent[locId]--;
+            dec_success = true;
+        }
+    } else {
+        shared->noOfNodesPresent[locId]++;
+        inc_success = true;
+    }
+
+    if(inc_success || dec_success) {
+        shared->noteChange(locId);
+
+#ifdef SWIM_STATS
+        // the location had the number of nodes before the change until now
+        shared->stats.noteOccupancy(locId, shared->noOfNodesPresent[locId] + (inc_success ? -1 : 1), statsTime());
+#endif
+
+        // with parallel simulation, the change is sent to the other
+        // partitions at the next exchange
+        if(shared->exchangingOccupancy) {
+            if(shared->occupancyChanges[locId] == 0) {
+                shared->changedLocations.push_back(locId);
+            }
+            shared->occupancyChanges[locId] += (inc_success ? 1 : -1);
+        }
+    }
+
+    if(inc_success) {
+        return 1;
+    } else if(dec_success) {
+        return 2;
+    } else {
+        return 0;
+    }
+}
+
+void SWIMModel::updateAllNodes(bool increase) {
+    SWIM_STATS_TIMER(SWIM_TIMER_UPDATE);
+
+    // all nodes refer to the same locations table, so a single
+    // update makes the node count visible to every node
+    int update = updateNodesCount(destLocId, increase);
+
+    // the members of a location are the nodes in its node count
+    if(update == 1) {
+        joinMembers(destLocId);
+    } else if(update == 2) {
+        leaveMembers();
+    }
+}
+
+void SWIMModel::joinMembers(int locId)
+{
+    leaveMembers();
+    if(locId < 0 || locId >= (int) shared->firstMembers.size()) {
+        return;
+    }
+
+    // the node becomes the first member
+    SWIMModel *&first = shared->firstMembers[locId];
+    memberLocId = locId;
+    previousMember = nullptr;
+    nextMember = first;
+    if(first != nullptr) {
+        first->previousMember = this;
+    }
+    first = this;
+}
+
+void SWIMModel::leaveMembers()
+{
+    if(memberLocId < 0) {
+        return;
+    }
+
+    if(previousMember != nullptr) {
+        previousMember->nextMember = nextMember;
+    } else {
+        shared->firstMembers[memberLocId] = nextMember;
+    }
+    if(nextMember != nullptr) {
+        nextMember->previousMember = previousMember;
+    }
+    memberLocId = -1;
+    previousMember = nullptr;
+    nextMember = nullptr;
+}
+
+void SWIMModel::findMembers(int locId, std::vector<SWIMModel *> &found) const
+{
+    found.clear();
+    if(locId < 0 || locId >= (int) shared->firstMembers.size()) {
+        return;
+    }
+
+    for(SWIMModel *member = shared->firstMembers[locId]; member != nullptr; member = member->nextMember) {
+        found.push_back(member);
+    }
+}
+
+#ifdef SWIM_STATS
+void SWIMModel::countPick(bool neighbor)
+{
+    // no location in either list
+    if(destLocId < 0) {
+        return;
+    }
+
+    if(neighbor) {
+        SWIM_STATS_COUNT(neighborPicks);
+    } else {
+        SWIM_STATS_COUNT(visitingPicks);
+    }
+    if(locationWeight(destLocId) > POPULAR_WEIGHT) {
+        SWIM_STATS_COUNT(popularPicks);
+    } else {
+        SWIM_STATS_COUNT(notPopularPicks);
+    }
+}
+#endif
+
+SWIMModel::~SWIMModel() {
+
+    // a deleted node is no longer found at its location
+    if(shared) {
+        leaveMembers();
+    }
+}
+
+} // namespace inet
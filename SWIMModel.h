@@ -0,0 +1,455 @@
+/******************************************************************************
+ * SWIMMobility - A SWIM implementation for the INET Framework of the OMNeT++
+ * Simulator.
+ *
+ * Copyright (C) 2016, Sustainable Communication Networks, University of Bremen, Germany
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ *
+ ******************************************************************************/
+
+/**
+* The C++ include file of the SWIM model logic of one node (location
+* creation, weights, decisions and the return to home), kept free of
+* OMNeT++ so that it can also be used without a simulation. Random
+* numbers are obtained through drawUniform(), drawIntUniform() and
+* drawUniformBlock(), which the users of the model implement.
+*
+* @author : Anas bin Muslim (anas1@uni-bremen.de)
+*
+*/
+
+#ifndef __INET_SWIMMODEL_H
+#define __INET_SWIMMODEL_H
+
+#include <stdint.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "inet/mobility/single/SWIMDefs.h"
+#include "inet/mobility/single/SWIMKernels.h"
+#include "inet/mobility/single/SWIMLocationGenerator.h"
+#include "inet/mobility/single/SWIMLocations.h"
+#include "inet/mobility/single/SWIMSnapshot.h"
+#include "inet/mobility/single/SWIMStats.h"
+#include "inet/mobility/single/SWIMTrace.h"
+
+// a location in the neighbouring or visiting list of a node, where the
+// coordinates and node count are taken from the shared tables and the
+// weight is computed from them when needed (the location is popular
+// from popularFrom nodes present on, INT32_MAX for never)
+struct nodeProp {
+    int locId = -1;
+    int popularFrom = INT32_MAX;
+    double distTerm = 0;
+};
+#ifndef PI
+#define PI 3.14159265
+#endif
+#define POPULAR_WEIGHT          0.75
+#define NO_SLOT                 INT32_MIN
+
+// random numbers and positions around a location drawn at once by a
+// node, when batched (the disc block is a multiple of the vector width)
+#define RANDOM_BLOCK            16
+#define DISC_BLOCK              8
+
+namespace inet {
+
+class SWIMModel;
+
+// running sums of the weights of a list of locations (a Fenwick tree),
+// to draw a location with a probability proportional to its weight in
+// O(log L) while the weights keep changing
+struct weightTree {
+    std::vector<double> weights;
+    std::vector<double> sums;
+    double sum = 0.0;
+
+    /** Builds the sums over the given weights **/
+    void reset(const std::vector<double> &values);
+
+    /** Changes the weight of one entry **/
+    void set(int index, double weight);
+
+    /** Finds the entry at which the running sum passes the given value (below sum) **/
+    int find(double value) const;
+};
+
+// uniform grid over the x and y coordinates of the locations, to find the
+// locations within a distance without looking at all of them
+struct locationGrid {
+    double originX = 0.0;
+    double originY = 0.0;
+    double cellSize = 0.0;
+    int cellsX = 0;
+    int cellsY = 0;
+
+    // the locations of cell c are cellLocations[cellStarts[c] .. cellStarts[c + 1])
+    std::vector<int> cellStarts;
+    std::vector<int> cellLocations;
+
+    /** Builds the grid over the given locations, with cells of (at least) the given size **/
+    void build(const float *x, const float *y, int count, double cellSize);
+
+    /** Finds the locations within the given distance (in the order of their ids), in 2 or 3 dimensions **/
+    template<int dims>
+    void query(const float *x, const float *y, const float *z, double positionX, double positionY, double positionZ,
+            double distance, std::vector<int> &found) const;
+
+    bool isBuilt() const { return !cellStarts.empty(); }
+};
+
+// state shared by all the SWIM nodes of one simulation: the locations
+// (mapped read-only from the locations file, and copied into separate
+// x, y and z arrays for the kernels, with no z array in 2 dimensions),
+// the number of nodes present at each
+// of them and the ring of the most recently changed locations (as many as
+// there are locations) with the total number of changes made
+struct swimShared {
+    SWIMLocationsFile locationsFile;
+    const loc *locations = nullptr;
+    std::vector<float> locationsX;
+    std::vector<float> locationsY;
+    std::vector<float> locationsZ;
+    std::vector<int> noOfNodesPresent;
+    std::vector<int> locationChanges;
+    int64_t locationChangeCount = 0;
+
+    // the first of the nodes at or heading to each location, which are
+    // linked through the nodes themselves (see SWIMModel::nextMember)
+    std::vector<SWIMModel *> firstMembers;
+
+    // with implicit visiting locations, the grid used to find the
+    // neighbouring locations and the locations with enough nodes present
+    // to be popular for some node (with their position in that list),
+    // which is kept on every change of a node count once any node uses
+    // it, for the smallest number of nodes any of them needs (-1 while
+    // no node uses it)
+    locationGrid locationIndex;
+    std::mutex locationIndexMutex;
+    std::vector<int> crowdedLocations;
+    std::vector<int> crowdedSlots;
+    int minCrowdedSeen = -1;
+
+    // with threads to separate the locations on (SWIMMobility only), the
+    // nodes by their slot (null once deleted) and the times at which they
+    // next decide a move, where the first of them deciding at a time
+    // separates the locations of all of them (up to the time prepared)
+    std::vector<SWIMModel *> deciders;
+    std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int>>, std::greater<std::pair<double, int>>> decisionTimes;
+    double preparedTime = -1;
+
+    // trace the nodes replay their segments from (replay mode only), with
+    // the nodes of it taken by a host
+    SWIMTraceReader replayTrace;
+    std::vector<bool> replayedNodes;
+
+    // homes of the nodes and their states at the end of the warm-up
+    // (warm-up only)
+    std::vector<Coord> warmUpHomes;
+    std::vector<swimNodeState> warmUpStates;
+
+    // the state the nodes start from and the one saved at the end, with
+    // the nodes of them taken by a host (and the number of nodes, to know
+    // when all of them are saved)
+    SWIMSnapshot restoredState;
+    SWIMSnapshot savedState;
+    std::vector<bool> restoredNodes;
+    std::vector<bool> savedNodes;
+    int noOfNodes = 0;
+    int noOfSavedNodes = 0;
+
+    // with parallel simulation, the node counts also hold the nodes of the
+    // other partitions, whose changes are exchanged (see
+    // SWIMOccupancyExchange); the changes made in this partition since the
+    // last exchange are summed per location
+    bool exchangingOccupancy = false;
+    std::vector<int> occupancyChanges;
+    std::vector<int> changedLocations;
+
+#ifdef SWIM_STATS
+    // statistics of all the nodes, written once all nodes finished
+    SWIMStats stats;
+    int noOfFinishedNodes = 0;
+#endif
+
+    /** Uses the locations of locationsFile, with no nodes present **/
+    void reset(int noOfLocs, int dimensions);
+
+    /** Sets the node counts and members of the given number of locations, with no nodes present (without any locations in replay mode) **/
+    void resetCounts(int noOfLocs);
+
+    /** Records a changed node count for the cached weights and the crowded locations **/
+    void noteChange(int locId);
+
+    /** Keeps the crowded locations from now on, with at least the given number of nodes present (if lower than before) **/
+    void trackCrowded(int minCrowded);
+
+    /** Adds the changes of the node counts made in another partition **/
+    void applyOccupancyChanges(const std::vector<int> &locIds, const std::vector<int> &changes);
+};
+
+class INET_API SWIMModel
+{
+protected:
+    bool firstStep;
+
+    int popularityDecisionThreshold;
+    int returnHomePercentage;
+    int dimensions;
+
+    double neighbourLocationLimit;
+    double alpha = 0.0;
+    double radius;
+
+    // in 2 dimensions, the distances leave out the z coordinates (of the
+    // locations, which are all 0, and of the home) and the area its height
+    bool twoDimensional;
+    swimDistancesKernel distancesKernel;
+
+    // released with the last node of the simulation
+    std::shared_ptr<swimShared> shared;
+
+    std::vector<nodeProp> neighborLocs;
+    std::vector<nodeProp> visitingLocs;
+
+    // both lists hold the popular locations (weight above POPULAR_WEIGHT)
+    // first, followed by the not popular locations
+    int popularNeighbors;
+    int popularVisiting;
+
+    // when weights are cached, the position of each location in the
+    // neighboring (n) or visiting (-v - 1) list and the number of
+    // location changes already applied to the weights
+    bool cacheLocationWeights;
+    bool weightsCached;
+    std::vector<int> locSlots;
+    int64_t lastChangeSeen;
+    double maxWeight;
+
+    // the fewest nodes present for which any of the locations is popular
+    // for this node
+    int minPopularFrom;
+
+    // destinations are drawn in proportion to the weights (instead of
+    // from the popular or not popular locations), and the positions
+    // around a location by rejection sampling (instead of polar)
+    bool weightedSelection;
+    bool fastDiscSampling;
+    weightTree neighborTree;
+    weightTree visitingTree;
+
+    // the random numbers of the decisions are taken from a block drawn
+    // at once, and the positions around a location from a block computed
+    // by the disc kernels (x first, then y), up to the next ones used
+    bool batchedRandomNumbers;
+    std::vector<double> randomBlock;
+    int nextRandom;
+    std::vector<double> discBlock;
+    int nextDisc;
+
+    // the visiting locations may be left implicit (all locations that are
+    // not neighbouring), in which case the neighbouring locations come from
+    // the grid and the cached weights are found through neighborSlots; this
+    // needs locations to be crowded (minCrowdedSeen nodes present) to be
+    // popular, and is only used by nodes with at most half the locations
+    // as neighbours
+    bool implicitVisiting;
+    bool visitingImplicit;
+    int minCrowdedSeen;
+    std::unordered_map<int, int> neighborSlots;
+
+    // the locations were separated ahead of the next decision (see
+    // prepareLocations())
+    bool locationsPrepared;
+
+    // the location whose node count holds this node (-1 for none), with
+    // the previous and next nodes counted at that location
+    int memberLocId;
+    SWIMModel *previousMember;
+    SWIMModel *nextMember;
+
+#ifdef SWIM_STATS
+    swimCounters counters;
+#endif
+
+    int destLocId;
+    Coord homeCoord;
+
+    // how the locations are created (one by one and uniformly, unless
+    // another layout or a minimum separation is given)
+    swimLayoutParams locationLayout;
+
+public:
+    int noOfLocs;
+    int nodes;
+
+    double maxAreaX;
+    double maxAreaY;
+    double maxAreaZ;
+
+protected:
+    /** Returns a random number between a and b, from the RNG used for SWIM **/
+    virtual double drawUniform(double a, double b) = 0;
+
+    /** Returns a random integer between a and b (both included), from the RNG used for SWIM **/
+    virtual int drawIntUniform(int a, int b) = 0;
+
+    /** Fills the given numbers with random numbers in [0, 1), as drawUniform(0, 1) would one by one **/
+    virtual void drawUniformBlock(double *numbers, int count) = 0;
+
+    /** Returns a random number between a and b for a decision, from the block when batched **/
+    double nextUniform(double a, double b) {
+        if(!batchedRandomNumbers) {
+            return drawUniform(a, b);
+        }
+        if(nextRandom == RANDOM_BLOCK) {
+            drawUniformBlock(randomBlock.data(), RANDOM_BLOCK);
+            nextRandom = 0;
+        }
+        return a + (b - a) * randomBlock[nextRandom++];
+    }
+
+    /** Returns a random integer between a and b (both included) for a decision, from the block when batched **/
+    int nextIntUniform(int a, int b) {
+        if(!batchedRandomNumbers) {
+            return drawIntUniform(a, b);
+        }
+        return a + (int) nextUniform(0.0, (double) b - a + 1.0);
+    }
+
+#ifdef SWIM_STATS
+    /** Returns the current time, for the occupancy of the locations **/
+    virtual double statsTime() = 0;
+
+    /** Counts the destination just chosen from the neighboring or visiting locations **/
+    void countPick(bool neighbor);
+#endif
+
+    /** Resets the per-node state and computes the maximum weight, once the parameters are set **/
+    virtual void setupModel();
+
+    /** Creates random locations in the mobility area (in the layout given by locationLayout) **/
+    virtual bool generateLocations(std::vector<loc> &locs);
+
+    /** Chooses the next position (home or a location) to move to and updates the node counts **/
+    virtual Coord nextTargetPosition(const Coord &lastPosition);
+
+    /** Separates the visiting and neighboring locations and updates their weights **/
+    virtual void seperateAndUpdateWeights();
+
+    /** Separates the visiting and neighboring locations with their distance terms, which depends
+        only on the home (so nodes may do this in parallel, but not while other nodes decide) **/
+    virtual void prepareLocations();
+
+    /** Updates the weights of the locations whose node count changed **/
+    virtual void refreshWeights();
+
+    /** Records the position of every location in the neighboring and visiting lists **/
+    virtual void mapLocationSlots();
+
+    /** Updates the popular locations and the crowded ones (the only ones that can become popular), when
+        these are kept for at most the nodes present that make a location popular for this node **/
+    virtual bool refreshCrowdedLocations();
+
+    /** Moves the popular locations to the front of the neighboring and visiting lists **/
+    virtual void partitionLocations();
+
+    /** Updates the weight of one location and keeps its list partitioned **/
+    virtual void updateWeight(std::vector<nodeProp> &array, int &popular, int index);
+
+    /** Decides whether neighbor or visiting locations is to be visited next **/
+    virtual Coord decision();
+
+    /** Chooses a random set of Coordinates from given (partitioned) array **/
+    virtual Coord chooseDestination(std::vector<nodeProp> &array, int popular);
+
+    /** Returns a random offset within the radius around a location **/
+    virtual Coord drawDiscOffset();
+
+    /** Finds the locations within the given distance of a position in the grid (built by the first node that needs it) **/
+    void findLocationsNear(const Coord &position, double distance, std::vector<int> &found) const;
+
+    /** Finds the neighbouring locations in the grid, leaving the visiting ones implicit **/
+    virtual bool seperateNeighbors();
+
+    /** Chooses a destination from the implicit visiting locations **/
+    virtual Coord chooseVisitingDestination();
+
+    /** Distance of a location to the home, as computed by the kernels **/
+    double locationDistance(int locId) const {
+        return twoDimensional ? swimLocationDistance<2>(shared->locationsX.data(), shared->locationsY.data(), nullptr, locId, homeCoord.x, homeCoord.y, 0.0)
+                : swimLocationDistance<3>(shared->locationsX.data(), shared->locationsY.data(), shared->locationsZ.data(), locId, homeCoord.x, homeCoord.y, homeCoord.z);
+    }
+
+    /** Weight of a location for this node **/
+    double locationWeight(int locId) const;
+
+    /** Weight of a location of the neighboring or visiting list, from its cached distance term **/
+    double weightOf(const nodeProp &prop) const;
+    bool isPopular(const nodeProp &prop) const { return shared->noOfNodesPresent[prop.locId] >= prop.popularFrom; }
+
+    /** Smallest number of nodes present for which a location with the given distance term is popular (INT32_MAX for none) **/
+    int popularCount(double distTerm) const;
+
+    /** Moves the popular locations of a list to the front (swapping from both ends as std::partition does) and
+        returns their number, keeping the slots of the swapped locations when mapped **/
+    int partitionList(std::vector<nodeProp> &array, bool neighbors, bool slotsMapped);
+
+    /** Position in the neighboring (n) or visiting (-v - 1) list, or NO_SLOT **/
+    int findLocSlot(int locId) const;
+    void setLocSlot(int locId, int slot);
+
+    /** Updates the number of nodes at the given location **/
+    virtual int updateNodesCount(int locId, bool inc);
+
+    /** Used to update the locations table shared by all of the nodes **/
+    virtual void updateAllNodes(bool increase);
+
+    /** Adds the node to the members of a location (leaving the one it was at) **/
+    void joinMembers(int locId);
+
+    /** Removes the node from the members of its location **/
+    void leaveMembers();
+
+public:
+    /** Location the node is at or heading to (-1 for home) **/
+    int getDestination() const { return destLocId; }
+
+    /** Separates the locations of the given nodes on the threads (none for a few nodes), ahead of their decisions **/
+    static void prepareLocationsOf(const std::vector<SWIMModel *> &nodes, int threads);
+
+#ifdef SWIM_STATS
+    const swimCounters &getCounters() const { return counters; }
+#endif
+
+    /** Finds the nodes at or heading to a location (those counted in its node count) **/
+    void findMembers(int locId, std::vector<SWIMModel *> &found) const;
+
+    /** Constructor **/
+    SWIMModel();
+
+    /** Destructor **/
+    virtual ~SWIMModel();
+
+};
+
+}//namespace inet
+
+#endif
@@ -0,0 +1,200 @@
+/******************************************************************************
+ * SWIMMobility - A SWIM implementation for the INET Framework of the OMNeT++
+ * Simulator.
+ *
+ * Copyright (C) 2016, Sustainable Communication Networks, University of Bremen, Germany
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ *
+ ******************************************************************************/
+
+/**
+ * The C++ implementation file of the exchange of node counts between the
+ * partitions of a parallel simulation.
+ *
+ * @author : Anas bin Muslim (anas1@uni-bremen.de)
+ *
+ */
+
+#include "inet/mobility/single/SWIMOccupancyExchange.h"
+#include "inet/mobility/single/SWIMMobility.h"
+
+namespace inet {
+
+Register_Class(SWIMOccupancyMessage);
+
+Define_Module(SWIMOccupancyExchange);
+
+void SWIMOccupancyMessage::parsimPack(cCommBuffer *buffer) const
+{
+    cMessage::parsimPack(buffer);
+
+    int count = locIds.size();
+    buffer->pack(noOfLocations);
+    buffer->pack(locationsHash);
+    buffer->pack(count);
+    buffer->pack(locIds.data(), count);
+    buffer->pack(changes.data(), count);
+}
+
+void SWIMOccupancyMessage::parsimUnpack(cCommBuffer *buffer)
+{
+    cMessage::parsimUnpack(buffer);
+
+    int count = 0;
+    buffer->unpack(noOfLocations);
+    buffer->unpack(locationsHash);
+    buffer->unpack(count);
+    locIds.resize(count);
+    changes.resize(count);
+    buffer->unpack(locIds.data(), count);
+    buffer->unpack(changes.data(), count);
+}
+
+SWIMOccupancyExchange::SWIMOccupancyExchange()
+{
+    exchangeTimer = nullptr;
+    locationsHash = 0;
+    locationsHashed = false;
+    receivedChanges = 0;
+}
+
+SWIMOccupancyExchange::~SWIMOccupancyExchange()
+{
+    cancelAndDelete(exchangeTimer);
+}
+
+void SWIMOccupancyExchange::initialize()
+{
+    exchangeInterval = par("exchangeInterval");
+    if(exchangeInterval <= 0) {
+        throw cRuntimeError("SWIM :: The exchangeInterval must be positive");
+    }
+
+    // the nodes of this partition record their changes from now on (they
+    // change the node counts only once they head to their first targets)
+    shared = findSharedState(getSimulation());
+    shared->exchangingOccupancy = true;
+    receivedChanges = 0;
+
+    exchangeTimer = new cMessage("exchangeOccupancy");
+    scheduleAt(simTime() + exchangeInterval, exchangeTimer);
+}
+
+void SWIMOccupancyExchange::handleMessage(cMessage *msg)
+{
+    if(msg == exchangeTimer) {
+        sendChanges();
+        scheduleAt(simTime() + exchangeInterval, exchangeTimer);
+        return;
+    }
+
+    SWIMOccupancyMessage *changes = dynamic_cast<SWIMOccupancyMessage *>(msg);
+    if(changes == nullptr) {
+        throw cRuntimeError("SWIM :: Unexpected message '%s' at the occupancy exchange", msg->getName());
+    }
+    receiveChanges(changes);
+    delete msg;
+}
+
+void SWIMOccupancyExchange::sendChanges()
+{
+    // the nodes may change a count and change it back before the exchange
+    // (or list a location again), so only the remaining changes are sent
+    SWIMOccupancyMessage *msg = new SWIMOccupancyMessage("occupancyChanges");
+    for(int locId : shared->changedLocations) {
+        if(shared->occupancyChanges[locId] != 0) {
+            msg->locIds.push_back(locId);
+            msg->changes.push_back(shared->occupancyChanges[locId]);
+            shared->occupancyChanges[locId] = 0;
+        }
+    }
+    shared->changedLocations.clear();
+
+    if(msg->locIds.empty()) {
+        delete msg;
+        return;
+    }
+
+    msg->noOfLocations = shared->noOfNodesPresent.size();
+    msg->locationsHash = getLocationsHash();
+    int gates = gateSize("out");
+    for(int i = 0; i < gates; i++) {
+        send(i < gates - 1 ? msg->dup() : msg, "out", i);
+    }
+    if(gates == 0) {
+        delete msg;
+    }
+}
+
+void SWIMOccupancyExchange::receiveChanges(SWIMOccupancyMessage *msg)
+{
+    // a partition without SWIM nodes has no node counts to keep
+    if(shared->locations == nullptr) {
+        return;
+    }
+
+    // other locations would make the counts meaningless
+    if(msg->noOfLocations != (int) shared->noOfNodesPresent.size() || msg->locationsHash != getLocationsHash()) {
+        throw cRuntimeError("SWIM :: Partitions use different locations (use the same locationsFile or importLocationsFile in all of them)");
+    }
+
+#ifdef SWIM_STATS
+    // the locations had their numbers of nodes until now
+    for(int locId : msg->locIds) {
+        if(locId >= 0 && locId < (int) shared->noOfNodesPresent.size()) {
+            shared->stats.noteOccupancy(locId, shared->noOfNodesPresent[locId], simTime().dbl());
+        }
+    }
+#endif
+
+    shared->applyOccupancyChanges(msg->locIds, msg->changes);
+    for(int change : msg->changes) {
+        receivedChanges += change;
+    }
+}
+
+void SWIMOccupancyExchange::finish()
+{
+    // every partition counts the nodes of all partitions, so its nodes
+    // present match the sum of the nodes of the partitions (once the
+    // changes of the last intervals arrived), and a serial run of the
+    // same movement
+    int64_t nodesPresent = 0;
+    for(int count : shared->noOfNodesPresent) {
+        nodesPresent += count;
+    }
+    recordScalar("nodesPresent", nodesPresent);
+    recordScalar("partitionNodesPresent", nodesPresent - receivedChanges);
+}
+
+uint32_t SWIMOccupancyExchange::getLocationsHash()
+{
+    if(locationsHashed || shared->locations == nullptr) {
+        return locationsHash;
+    }
+
+    // FNV-1a over the coordinates of all locations
+    const unsigned char *bytes = (const unsigned char *) shared->locations;
+    size_t size = shared->noOfNodesPresent.size() * sizeof(loc);
+    locationsHash = 2166136261u;
+    for(size_t i = 0; i < size; i++) {
+        locationsHash = (locationsHash ^ bytes[i]) * 16777619u;
+    }
+    locationsHashed = true;
+
+    return locationsHash;
+}
+
+}//namespace inet
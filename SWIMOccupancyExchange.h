@@ -0,0 +1,110 @@
+/******************************************************************************
+ * SWIMMobility - A SWIM implementation for the INET Framework of the OMNeT++
+ * Simulator.
+ *
+ * Copyright (C) 2016, Sustainable Communication Networks, University of Bremen, Germany
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ *
+ ******************************************************************************/
+
+/**
+* The C++ include file of the exchange of node counts between the
+* partitions of a parallel simulation. Every partition has one exchange
+* module, connected to those of all other partitions. The changes of the
+* node counts made by the SWIM nodes of a partition are summed per
+* location and sent to the other partitions at every exchange interval,
+* which add them to their node counts.
+*
+* @author : Anas bin Muslim (anas1@uni-bremen.de)
+*
+*/
+
+#ifndef __INET_SWIMOCCUPANCYEXCHANGE_H
+#define __INET_SWIMOCCUPANCYEXCHANGE_H
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include "inet/common/INETDefs.h"
+#include "inet/mobility/single/SWIMModel.h"
+
+namespace inet {
+
+// the changes of the node counts of one partition since its last exchange,
+// with a fingerprint of its locations (all partitions must use the same)
+class INET_API SWIMOccupancyMessage : public cMessage
+{
+public:
+    int noOfLocations = 0;
+    uint32_t locationsHash = 0;
+    std::vector<int> locIds;
+    std::vector<int> changes;
+
+public:
+    explicit SWIMOccupancyMessage(const char *name = nullptr) : cMessage(name) {}
+    SWIMOccupancyMessage(const SWIMOccupancyMessage &other) = default;
+
+    virtual SWIMOccupancyMessage *dup() const override { return new SWIMOccupancyMessage(*this); }
+
+    /** Packs the changes to be sent to another partition **/
+    virtual void parsimPack(cCommBuffer *buffer) const override;
+
+    /** Unpacks the changes received from another partition **/
+    virtual void parsimUnpack(cCommBuffer *buffer) override;
+};
+
+class INET_API SWIMOccupancyExchange : public cSimpleModule
+{
+protected:
+    simtime_t exchangeInterval;
+    cMessage *exchangeTimer;
+
+    // released with the last node (or this module) of the simulation
+    std::shared_ptr<swimShared> shared;
+    uint32_t locationsHash;
+    bool locationsHashed;
+
+    // the changes of the node counts received from the other partitions
+    int64_t receivedChanges;
+
+protected:
+    virtual void initialize() override;
+
+    virtual void handleMessage(cMessage *msg) override;
+
+    /** Records the nodes counted at the locations, in all partitions and in this one **/
+    virtual void finish() override;
+
+    /** Sends the changes made in this partition since the last exchange to all other partitions **/
+    virtual void sendChanges();
+
+    /** Adds the changes of another partition to the node counts **/
+    virtual void receiveChanges(SWIMOccupancyMessage *msg);
+
+    /** Fingerprint of the locations (computed once they are there) **/
+    uint32_t getLocationsHash();
+
+public:
+    /** Constructor **/
+    SWIMOccupancyExchange();
+
+    /** Destructor **/
+    ~SWIMOccupancyExchange();
+};
+
+}//namespace inet
+
+#endif
@@ -0,0 +1,139 @@
+/******************************************************************************
+ * SWIMMobility - A SWIM implementation for the INET Framework of the OMNeT++
+ * Simulator.
+ *
+ * Copyright (C) 2016, Sustainable Communication Networks, University of Bremen, Germany
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ *
+ ******************************************************************************/
+
+/**
+ * The C++ implementation file of the SWIM snapshot.
+ *
+ * @author : Anas bin Muslim (anas1@uni-bremen.de)
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "inet/mobility/single/SWIMSnapshot.h"
+
+namespace inet {
+
+bool SWIMSnapshot::write(const char *fileName) const
+{
+    snapshotHeader header;
+    std::vector<int32_t> counts(noOfNodesPresent.begin(), noOfNodesPresent.end());
+    std::vector<snapshotNode> nodes(homes.size());
+    FILE *file;
+
+    if(states.size() != homes.size() || noOfNodesPresent.size() != locations.size()
+            || (file = fopen(fileName, "wb")) == nullptr) {
+        return false;
+    }
+
+    memset(&header, 0, sizeof(header));
+    strncpy(header.magic, SNAPSHOT_FILE_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_FILE_VERSION;
+    header.noOfNodes = homes.size();
+    header.noOfLocations = locations.size();
+    header.time = time;
+
+    for(int i = 0; i < (int) homes.size(); i++) {
+        snapshotNode &node = nodes[i];
+        node.homeX = homes[i].x;
+        node.homeY = homes[i].y;
+        node.homeZ = homes[i].z;
+        node.positionX = states[i].position.x;
+        node.positionY = states[i].position.y;
+        node.positionZ = states[i].position.z;
+        node.targetX = states[i].target.x;
+        node.targetY = states[i].target.y;
+        node.targetZ = states[i].target.z;
+        node.endTime = states[i].endTime;
+        node.locId = states[i].locId;
+        node.waitNext = states[i].waitNext;
+    }
+
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1
+            && fwrite(locations.data(), sizeof(loc), locations.size(), file) == locations.size()
+            && fwrite(counts.data(), sizeof(int32_t), counts.size(), file) == counts.size()
+            && fwrite(nodes.data(), sizeof(snapshotNode), nodes.size(), file) == nodes.size();
+
+    return (fclose(file) == 0) && written;
+}
+
+bool SWIMSnapshot::read(const char *fileName)
+{
+    snapshotHeader header;
+    std::vector<int32_t> counts;
+    std::vector<snapshotNode> nodes;
+    FILE *file;
+
+    clear();
+    if((file = fopen(fileName, "rb")) == nullptr) {
+        return false;
+    }
+
+    // check that the file is a snapshot file
+    bool read = fread(&header, sizeof(header), 1, file) == 1
+            && strncmp(header.magic, SNAPSHOT_FILE_MAGIC, sizeof(header.magic)) == 0
+            && header.version == SNAPSHOT_FILE_VERSION
+            && header.noOfNodes >= 0
+            && header.noOfLocations >= 0;
+
+    if(read) {
+        locations.resize(header.noOfLocations);
+        counts.resize(header.noOfLocations);
+        nodes.resize(header.noOfNodes);
+        read = fread(locations.data(), sizeof(loc), locations.size(), file) == locations.size()
+                && fread(counts.data(), sizeof(int32_t), counts.size(), file) == counts.size()
+                && fread(nodes.data(), sizeof(snapshotNode), nodes.size(), file) == nodes.size();
+    }
+    fclose(file);
+
+    if(!read) {
+        clear();
+        return false;
+    }
+
+    time = header.time;
+    noOfNodesPresent.assign(counts.begin(), counts.end());
+    homes.resize(nodes.size());
+    states.resize(nodes.size());
+    for(int i = 0; i < (int) nodes.size(); i++) {
+        const snapshotNode &node = nodes[i];
+        homes[i] = Coord(node.homeX, node.homeY, node.homeZ);
+        states[i].position = Coord(node.positionX, node.positionY, node.positionZ);
+        states[i].target = Coord(node.targetX, node.targetY, node.targetZ);
+        states[i].endTime = node.endTime;
+        states[i].locId = node.locId;
+        states[i].waitNext = (node.waitNext != 0);
+    }
+
+    return true;
+}
+
+void SWIMSnapshot::clear()
+{
+    time = 0.0;
+    locations.clear();
+    noOfNodesPresent.clear();
+    homes.clear();
+    states.clear();
+}
+
+}//namespace inet
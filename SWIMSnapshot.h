@@ -0,0 +1,109 @@
+/******************************************************************************
+ * SWIMMobility - A SWIM implementation for the INET Framework of the OMNeT++
+ * Simulator.
+ *
+ * Copyright (C) 2016, Sustainable Communication Networks, University of Bremen, Germany
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ *
+ ******************************************************************************/
+
+/**
+* The C++ include file of the SWIM snapshot, which holds the state of a
+* whole population at one point in time: the locations and the number of
+* nodes present at each of them, and the home of every node with the move
+* or wait it is in. A population run once (e.g., up to a steady state) is
+* saved in a binary file, from which any number of runs can start. The
+* file holds a header, the locations, the node counts and the nodes.
+*
+* @author : Anas bin Muslim (anas1@uni-bremen.de)
+*
+*/
+
+#ifndef __INET_SWIMSNAPSHOT_H
+#define __INET_SWIMSNAPSHOT_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "inet/mobility/single/SWIMDefs.h"
+#include "inet/mobility/single/SWIMLocations.h"
+
+#define SNAPSHOT_FILE_MAGIC     "SWIMSNP"
+#define SNAPSHOT_FILE_VERSION   1
+
+struct snapshotHeader {
+    char magic[8];
+    uint32_t version;
+    int32_t noOfNodes;
+    int32_t noOfLocations;
+    int32_t reserved;
+    double time;
+};
+
+// entry of the node table, which follows the locations and node counts
+struct snapshotNode {
+    double homeX;
+    double homeY;
+    double homeZ;
+    double positionX;
+    double positionY;
+    double positionZ;
+    double targetX;
+    double targetY;
+    double targetZ;
+    double endTime;
+    int32_t locId;
+    int32_t waitNext;
+};
+
+namespace inet {
+
+// state of a node at a point in time: its position, the target and end
+// time of the move or wait it is in (heading to location locId, -1 for
+// home) and whether it waits next
+struct swimNodeState {
+    Coord position;
+    Coord target;
+    double endTime = 0.0;
+    int locId = -1;
+    bool waitNext = false;
+};
+
+class INET_API SWIMSnapshot
+{
+public:
+    double time = 0.0;
+    std::vector<loc> locations;
+    std::vector<int> noOfNodesPresent;
+    std::vector<Coord> homes;
+    std::vector<swimNodeState> states;
+
+public:
+    /** Writes the snapshot to a file **/
+    bool write(const char *fileName) const;
+
+    /** Reads a snapshot from a file written by write() **/
+    bool read(const char *fileName);
+
+    /** Empties the snapshot **/
+    void clear();
+
+    bool isEmpty() const { return homes.empty() && locations.empty(); }
+    int getNoOfNodes() const { return homes.size(); }
+};
+
+}//namespace inet
+
+#endif
@@ -0,0 +1,131 @@
+/******************************************************************************
+ * SWIMMobility - A SWIM implementation for the INET Framework of the OMNeT++
+ * Simulator.
+ *
+ * Copyright (C) 2016, Sustainable Communication Networks, University of Bremen, Germany
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ *
+ ******************************************************************************/
+
+/**
+ * The C++ implementation file of the SWIM instrumentation.
+ *
+ * @author : Anas bin Muslim (anas1@uni-bremen.de)
+ *
+ */
+
+#include <stdio.h>
+
+#include "inet/mobility/single/SWIMStats.h"
+
+namespace inet {
+
+void SWIMStats::reset(int noOfLocs)
+{
+    total = swimCounters();
+    for(int i = 0; i < SWIM_TIMERS; i++) {
+        timers[i] = swimTimer();
+    }
+    nodeNames.clear();
+    nodeCounters.clear();
+    occupancy.assign(noOfLocs, std::vector<double>());
+    lastChange.assign(noOfLocs, 0.0);
+}
+
+void SWIMStats::addNode(const std::string &name, const swimCounters &counters)
+{
+    nodeNames.push_back(name);
+    nodeCounters.push_back(counters);
+}
+
+void SWIMStats::noteOccupancy(int locId, int noOfNodesPresent, double now)
+{
+    if(locId < 0 || locId >= (int) occupancy.size() || noOfNodesPresent < 0) {
+        return;
+    }
+
+    std::vector<double> &times = occupancy[locId];
+    if(noOfNodesPresent >= (int) times.size()) {
+        times.resize(noOfNodesPresent + 1, 0.0);
+    }
+    times[noOfNodesPresent] += now - lastChange[locId];
+    lastChange[locId] = now;
+}
+
+void SWIMStats::finishOccupancy(const std::vector<int> &noOfNodesPresent, double now)
+{
+    for(int i = 0; i < (int) noOfNodesPresent.size(); i++) {
+        noteOccupancy(i, noOfNodesPresent[i], now);
+    }
+}
+
+static void writeCounters(FILE *file, const swimCounters &counters)
+{
+    fprintf(file, "\"homeReturns\": %lld, \"neighborPicks\": %lld, \"visitingPicks\": %lld, "
+            "\"popularPicks\": %lld, \"notPopularPicks\": %lld, \"fallbacks\": %lld",
+            (long long) counters.homeReturns, (long long) counters.neighborPicks, (long long) counters.visitingPicks,
+            (long long) counters.popularPicks, (long long) counters.notPopularPicks, (long long) counters.fallbacks);
+}
+
+bool SWIMStats::writeJson(const char *fileName) const
+{
+    static const char *timerNames[SWIM_TIMERS] = { "seperateAndUpdateWeights", "decision", "updateAllNodes" };
+    FILE *file = fopen(fileName, "w");
+
+    if(file == nullptr) {
+        return false;
+    }
+
+    fprintf(file, "{\n  \"total\": { ");
+    writeCounters(file, total);
+    fprintf(file, " },\n  \"timers\": {\n");
+    for(int i = 0; i < SWIM_TIMERS; i++) {
+        fprintf(file, "    \"%s\": { \"calls\": %lld, \"cycles\": %llu, \"cyclesPerCall\": %.1f }%s\n",
+                timerNames[i], (long long) timers[i].calls, (unsigned long long) timers[i].cycles,
+                (timers[i].calls > 0 ? (double) timers[i].cycles / timers[i].calls : 0.0),
+                (i < SWIM_TIMERS - 1 ? "," : ""));
+    }
+    fprintf(file, "  },\n  \"nodes\": [\n");
+    for(size_t i = 0; i < nodeCounters.size(); i++) {
+        fprintf(file, "    { \"node\": \"%s\", ", nodeNames[i].c_str());
+        writeCounters(file, nodeCounters[i]);
+        fprintf(file, " }%s\n", (i + 1 < nodeCounters.size() ? "," : ""));
+    }
+    fprintf(file, "  ]\n}\n");
+
+    return fclose(file) == 0;
+}
+
+bool SWIMStats::writeOccupancyCsv(const char *fileName) const
+{
+    FILE *file = fopen(fileName, "w");
+
+    if(file == nullptr) {
+        return false;
+    }
+
+    fprintf(file, "location,nodes,time\n");
+    for(size_t i = 0; i < occupancy.size(); i++) {
+        for(size_t n = 0; n < occupancy[i].size(); n++) {
+            if(occupancy[i][n] > 0.0) {
+                fprintf(file, "%zu,%zu,%.6f\n", i, n, occupancy[i][n]);
+            }
+        }
+    }
+
+    return fclose(file) == 0;
+}
+
+}//namespace inet
@@ -0,0 +1,150 @@
+/******************************************************************************
+ * SWIMMobility - A SWIM implementation for the INET Framework of the OMNeT++
+ * Simulator.
+ *
+ * Copyright (C) 2016, Sustainable Communication Networks, University of Bremen, Germany
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ *
+ ******************************************************************************/
+
+
+/**
+* The C++ include file of the SWIM instrumentation, built in only when
+* SWIM_STATS is defined. It counts the decisions of the nodes (returns
+* home, neighbouring or visiting and popular or not popular locations,
+* and falls back to the other list), times the functions called at every
+* move in cycles (ticks of the time stamp counter) and keeps for every
+* location the time it had each number of nodes present. Without
+* SWIM_STATS, the macros below expand to nothing and the model holds no
+* statistics at all.
+*
+* @author : Anas bin Muslim (anas1@uni-bremen.de)
+*
+*/
+
+#ifndef __INET_SWIMSTATS_H
+#define __INET_SWIMSTATS_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <x86intrin.h>
+#elif !defined(__aarch64__)
+#include <chrono>
+#endif
+
+namespace inet {
+
+// decisions of a node (or of all nodes)
+struct swimCounters {
+    int64_t homeReturns = 0;
+    int64_t neighborPicks = 0;
+    int64_t visitingPicks = 0;
+    int64_t popularPicks = 0;
+    int64_t notPopularPicks = 0;
+    int64_t fallbacks = 0;
+};
+
+// the functions that are timed
+enum swimTimerId {
+    SWIM_TIMER_SEPERATE = 0,
+    SWIM_TIMER_DECISION,
+    SWIM_TIMER_UPDATE,
+    SWIM_TIMERS
+};
+
+struct swimTimer {
+    int64_t calls = 0;
+    uint64_t cycles = 0;
+};
+
+/** Current value of the cycle counter (nanoseconds where there is none) **/
+inline uint64_t swimCycles()
+{
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// adds the cycles from its creation to its end to a timer
+class swimScopedTimer
+{
+protected:
+    swimTimer &timer;
+    uint64_t start;
+
+public:
+    explicit swimScopedTimer(swimTimer &timer) : timer(timer), start(swimCycles()) {}
+    ~swimScopedTimer() { timer.calls++; timer.cycles += swimCycles() - start; }
+};
+
+// statistics of all the nodes of a simulation
+class SWIMStats
+{
+public:
+    swimCounters total;
+    swimTimer timers[SWIM_TIMERS];
+
+    // the counters of every node, added when the node finishes
+    std::vector<std::string> nodeNames;
+    std::vector<swimCounters> nodeCounters;
+
+    // for every location, the time it had n nodes present at index n,
+    // up to the time of its last change
+    std::vector<std::vector<double>> occupancy;
+    std::vector<double> lastChange;
+
+public:
+    /** Clears the statistics, for the given number of locations **/
+    void reset(int noOfLocs);
+
+    /** Adds the counters of one node to the list of nodes **/
+    void addNode(const std::string &name, const swimCounters &counters);
+
+    /** Records that a location had the given number of nodes present until now (when the number changes) **/
+    void noteOccupancy(int locId, int noOfNodesPresent, double now);
+
+    /** Closes the time of every location at the end, with its current number of nodes present **/
+    void finishOccupancy(const std::vector<int> &noOfNodesPresent, double now);
+
+    /** Writes the counters and timers as JSON **/
+    bool writeJson(const char *fileName) const;
+
+    /** Writes the occupancy as CSV lines of location, nodes present and time **/
+    bool writeOccupancyCsv(const char *fileName) const;
+};
+
+}//namespace inet
+
+// counting and timing in the model, only with SWIM_STATS
+#ifdef SWIM_STATS
+#define SWIM_STATS_COUNT(field)     (counters.field++, shared->stats.total.field++)
+#define SWIM_STATS_PICK(neighbor)   countPick(neighbor)
+#define SWIM_STATS_TIMER(id)        swimScopedTimer swimStatsTimer(shared->stats.timers[id])
+#else
+#define SWIM_STATS_COUNT(field)     ((void) 0)
+#define SWIM_STATS_PICK(neighbor)   ((void) 0)
+#define SWIM_STATS_TIMER(id)        ((void) 0)
+#endif
+
+#endif
@@ -0,0 +1,250 @@
+/******************************************************************************
+ * SWIMMobility - A SWIM implementation for the INET Framework of the OMNeT++
+ * Simulator.
+ *
+ * Copyright (C) 2016, Sustainable Communication Networks, University of Bremen, Germany
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ *
+ ******************************************************************************/
+
+/**
+ * The C++ implementation file of the binary SWIM trace.
+ *
+ * @author : Anas bin Muslim (anas1@uni-bremen.de)
+ *
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "inet/mobility/single/SWIMTrace.h"
+
+#ifdef _WIN32
+#define fseeko _fseeki64
+#endif
+
+namespace inet {
+
+SWIMTraceWriter::SWIMTraceWriter()
+{
+    file = nullptr;
+    noOfNodes = 0;
+    blockRecords = 0;
+    fileSize = 0;
+}
+
+SWIMTraceWriter::~SWIMTraceWriter()
+{
+    close();
+}
+
+bool SWIMTraceWriter::writeAt(uint64_t offset, const void *data, size_t size)
+{
+    return fseeko(file, offset, SEEK_SET) == 0 && fwrite(data, size, 1, file) == 1;
+}
+
+bool SWIMTraceWriter::open(const char *fileName, const std::vector<Coord> &homes, int noOfLocations, int blockRecords)
+{
+    traceHeader header;
+
+    close();
+    if(blockRecords <= 0 || (file = fopen(fileName, "wb")) == nullptr) {
+        return false;
+    }
+
+    this->noOfNodes = homes.size();
+    this->blockRecords = blockRecords;
+    pending.assign(noOfNodes, std::vector<traceRecord>());
+    lastBlocks.assign(noOfNodes, 0);
+
+    memset(&header, 0, sizeof(header));
+    strncpy(header.magic, TRACE_FILE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_FILE_VERSION;
+    header.noOfNodes = noOfNodes;
+    header.blockRecords = blockRecords;
+    header.noOfLocations = noOfLocations;
+    if(!writeAt(0, &header, sizeof(header))) {
+        return false;
+    }
+
+    // the first blocks are filled in when written
+    for(int i = 0; i < noOfNodes; i++) {
+        traceNode node;
+        node.homeX = homes[i].x;
+        node.homeY = homes[i].y;
+        node.homeZ = homes[i].z;
+        node.firstBlock = 0;
+        if(fwrite(&node, sizeof(node), 1, file) != 1) {
+            return false;
+        }
+    }
+    fileSize = sizeof(header) + noOfNodes * sizeof(traceNode);
+
+    return true;
+}
+
+bool SWIMTraceWriter::add(int node, const traceRecord &record)
+{
+    if(file == nullptr || node < 0 || node >= noOfNodes) {
+        return false;
+    }
+
+    pending[node].push_back(record);
+    return ((int) pending[node].size() < blockRecords || flushNode(node));
+}
+
+bool SWIMTraceWriter::flushNode(int node)
+{
+    traceBlock block;
+    uint64_t blockOffset = fileSize;
+
+    if(pending[node].empty()) {
+        return true;
+    }
+
+    // blocks always have the full size, so that they can be read at once
+    block.node = node;
+    block.count = pending[node].size();
+    block.nextBlock = 0;
+    pending[node].resize(blockRecords);
+    if(!writeAt(blockOffset, &block, sizeof(block))
+            || fwrite(pending[node].data(), sizeof(traceRecord), blockRecords, file) != (size_t) blockRecords) {
+        return false;
+    }
+    fileSize += sizeof(block) + blockRecords * sizeof(traceRecord);
+    pending[node].clear();
+
+    // chain the block to the node table or to the previous block of the node
+    uint64_t link = (lastBlocks[node] == 0 ? sizeof(traceHeader) + node * sizeof(traceNode) + offsetof(traceNode, firstBlock)
+                                            : lastBlocks[node] + offsetof(traceBlock, nextBlock));
+    lastBlocks[node] = blockOffset;
+
+    return writeAt(link, &blockOffset, sizeof(blockOffset));
+}
+
+bool SWIMTraceWriter::close()
+{
+    bool written = true;
+
+    if(file == nullptr) {
+        return false;
+    }
+
+    for(int i = 0; i < noOfNodes; i++) {
+        written = flushNode(i) && written;
+    }
+    written = (fclose(file) == 0) && written;
+
+    file = nullptr;
+    pending.clear();
+    lastBlocks.clear();
+
+    return written;
+}
+
+SWIMTraceReader::SWIMTraceReader()
+{
+    file = nullptr;
+    memset(&header, 0, sizeof(header));
+}
+
+SWIMTraceReader::~SWIMTraceReader()
+{
+    close();
+}
+
+bool SWIMTraceReader::readAt(uint64_t offset, void *data, size_t size)
+{
+    return fseeko(file, offset, SEEK_SET) == 0 && fread(data, size, 1, file) == 1;
+}
+
+bool SWIMTraceReader::open(const char *fileName)
+{
+    close();
+    if((file = fopen(fileName, "rb")) == nullptr) {
+        return false;
+    }
+
+    // check that the file is a trace file
+    if(!readAt(0, &header, sizeof(header))
+            || strncmp(header.magic, TRACE_FILE_MAGIC, sizeof(header.magic)) != 0
+            || header.version != TRACE_FILE_VERSION
+            || header.noOfNodes < 0
+            || header.blockRecords <= 0
+            || header.noOfLocations < 0) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void SWIMTraceReader::close()
+{
+    if(file != nullptr) {
+        fclose(file);
+    }
+    file = nullptr;
+    memset(&header, 0, sizeof(header));
+}
+
+bool SWIMTraceReader::start(int node, Coord &home, traceCursor &cursor)
+{
+    traceNode entry;
+
+    if(file == nullptr || node < 0 || node >= header.noOfNodes
+            || !readAt(sizeof(header) + node * sizeof(traceNode), &entry, sizeof(entry))) {
+        return false;
+    }
+
+    home.x = entry.homeX;
+    home.y = entry.homeY;
+    home.z = entry.homeZ;
+
+    cursor.nextBlock = entry.firstBlock;
+    cursor.index = 0;
+    cursor.records.clear();
+
+    return true;
+}
+
+bool SWIMTraceReader::next(traceCursor &cursor, traceRecord &record)
+{
+    // read the next block of the node when the current one is used up
+    if(cursor.index >= (int) cursor.records.size()) {
+        traceBlock block;
+
+        if(file == nullptr || cursor.nextBlock == 0 || !readAt(cursor.nextBlock, &block, sizeof(block))
+                || block.count < 0 || block.count > header.blockRecords) {
+            return false;
+        }
+        cursor.records.resize(block.count);
+        if(block.count > 0 && fread(cursor.records.data(), sizeof(traceRecord), block.count, file) != (size_t) block.count) {
+            cursor.records.clear();
+            return false;
+        }
+        cursor.nextBlock = block.nextBlock;
+        cursor.index = 0;
+
+        if(block.count == 0) {
+            return false;
+        }
+    }
+
+    record = cursor.records[cursor.index++];
+    return true;
+}
+
+}//namespace inet
@@ -0,0 +1,164 @@
+/******************************************************************************
+ * SWIMMobility - A SWIM implementation for the INET Framework of the OMNeT++
+ * Simulator.
+ *
+ * Copyright (C) 2016, Sustainable Communication Networks, University of Bremen, Germany
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ *
+ ******************************************************************************/
+
+/**
+* The C++ include file of the binary SWIM trace, which holds the segments
+* (moves and waits) of every node so that they can be replayed instead of
+* being computed again. The file starts with a header and a table with the
+* home and the first block of every node. The segments of a node are kept
+* in fixed size blocks that are chained to the next block of the same
+* node, so that a node reading its segments only needs one block in memory.
+*
+* @author : Anas bin Muslim (anas1@uni-bremen.de)
+*
+*/
+
+#ifndef __INET_SWIMTRACE_H
+#define __INET_SWIMTRACE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+
+#include "inet/mobility/single/SWIMDefs.h"
+
+#define TRACE_FILE_MAGIC        "SWIMTRC"
+#define TRACE_FILE_VERSION      2
+#define TRACE_BLOCK_RECORDS     64
+
+struct traceHeader {
+    char magic[8];
+    uint32_t version;
+    int32_t noOfNodes;
+    int32_t blockRecords;
+    int32_t noOfLocations;
+};
+
+// entry of the node table that follows the header
+struct traceNode {
+    double homeX;
+    double homeY;
+    double homeZ;
+    uint64_t firstBlock;
+};
+
+// a block of segments of one node (followed by blockRecords records,
+// of which count are used)
+struct traceBlock {
+    int32_t node;
+    int32_t count;
+    uint64_t nextBlock;
+};
+
+// one segment: the node moves from the previous target to this target
+// (or waits, if they are the same) until endTime, heading to the given
+// location (-1 for home), with the target exactly as generated
+struct traceRecord {
+    double endTime;
+    double targetX;
+    double targetY;
+    double targetZ;
+    int32_t locId;
+};
+
+// position of one node in the trace
+struct traceCursor {
+    uint64_t nextBlock = 0;
+    int index = 0;
+    std::vector<traceRecord> records;
+};
+
+namespace inet {
+
+class INET_API SWIMTraceWriter
+{
+protected:
+    FILE *file;
+    int noOfNodes;
+    int blockRecords;
+    uint64_t fileSize;
+
+    // the records not written yet and where the last block of each
+    // node was written (to chain the next block to it)
+    std::vector<std::vector<traceRecord>> pending;
+    std::vector<uint64_t> lastBlocks;
+
+protected:
+    /** Writes the pending records of a node as one block **/
+    bool flushNode(int node);
+
+    /** Writes at the given position of the file **/
+    bool writeAt(uint64_t offset, const void *data, size_t size);
+
+public:
+    /** Constructor **/
+    SWIMTraceWriter();
+
+    /** Destructor **/
+    ~SWIMTraceWriter();
+
+    /** Creates the trace file for the nodes with the given homes, heading to the given number of locations **/
+    bool open(const char *fileName, const std::vector<Coord> &homes, int noOfLocations, int blockRecords = TRACE_BLOCK_RECORDS);
+
+    /** Adds the next segment of a node **/
+    bool add(int node, const traceRecord &record);
+
+    /** Writes all pending records and closes the file **/
+    bool close();
+};
+
+class INET_API SWIMTraceReader
+{
+protected:
+    FILE *file;
+    traceHeader header;
+
+protected:
+    /** Reads from the given position of the file **/
+    bool readAt(uint64_t offset, void *data, size_t size);
+
+public:
+    /** Constructor **/
+    SWIMTraceReader();
+
+    /** Destructor **/
+    ~SWIMTraceReader();
+
+    /** Opens the trace file and checks its header **/
+    bool open(const char *fileName);
+
+    /** Closes the trace file **/
+    void close();
+
+    /** Gets the home of a node and places the cursor before its first segment **/
+    bool start(int node, Coord &home, traceCursor &cursor);
+
+    /** Reads the next segment of the node of the cursor (false at the end of the trace) **/
+    bool next(traceCursor &cursor, traceRecord &record);
+
+    bool isOpen() const { return file != nullptr; }
+    int getNoOfNodes() const { return header.noOfNodes; }
+    int getNoOfLocations() const { return header.noOfLocations; }
+};
+
+}//namespace inet
+
+#endif
@@ -0,0 +1,369 @@
+/******************************************************************************
+ * SWIMMobility - A SWIM implementation for the INET Framework of the OMNeT++
+ * Simulator.
+ *
+ * Copyright (C) 2016, Sustainable Communication Networks, University of Bremen, Germany
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ *
+ ******************************************************************************/
+
+/**
+ * The C++ implementation file of the headless SWIM trace generator.
+ *
+ * @author : Anas bin Muslim (anas1@uni-bremen.de)
+ *
+ */
+
+#include <algorithm>
+
+#include "inet/mobility/single/SWIMTraceGenerator.h"
+
+namespace inet {
+
+uint32_t SWIMHeadlessRng::intRand(uint32_t n)
+{
+    // draw with a bit mask and reject numbers out of range (as
+    // the Mersenne Twister of OMNeT++ does), so that all the
+    // numbers are equally likely
+    uint32_t max = n - 1;
+    uint32_t used = max;
+    used |= used >> 1;
+    used |= used >> 2;
+    used |= used >> 4;
+    used |= used >> 8;
+    used |= used >> 16;
+
+    uint32_t i;
+    do {
+        i = mt() & used;
+    } while (i > max);
+
+    return i;
+}
+
+double SWIMHeadlessNode::drawUniform(double a, double b)
+{
+    return a + (b - a) * rng->doubleRand();
+}
+
+int SWIMHeadlessNode::drawIntUniform(int a, int b)
+{
+    // the range is computed in 64 bits, as b - a + 1 overflows an int for b = INT32_MAX
+    return (int) (a + (int64_t) rng->intRand((uint32_t) ((int64_t) b - a + 1)));
+}
+
+void SWIMHeadlessNode::configure(const swimParams &params, std::shared_ptr<swimShared> shared, SWIMHeadlessRng *rng, const Coord &home)
+{
+    this->rng = rng;
+    this->shared = shared;
+
+    noOfLocs = params.noOfLocations;
+    nodes = params.hosts;
+    popularityDecisionThreshold = params.popularityDecisionThreshold;
+    returnHomePercentage = params.returnHomePercentage;
+    dimensions = params.dimensions;
+    neighbourLocationLimit = params.neighbourLocationLimit;
+    radius = params.radius;
+    alpha = params.alpha;
+    cacheLocationWeights = params.cacheLocationWeights;
+    weightedSelection = params.weightedSelection;
+    fastDiscSampling = params.fastDiscSampling;
+    batchedRandomNumbers = params.batchedRandomNumbers;
+    implicitVisiting = params.implicitVisiting;
+    maxAreaX = params.maxAreaX;
+    maxAreaY = params.maxAreaY;
+    maxAreaZ = params.maxAreaZ;
+    speed = params.speed;
+    waitTime = params.waitTime;
+    locationLayout = params.locationLayout;
+    locationLayout.threads = params.threads;
+
+    setupModel();
+
+    // the crowded locations serve the implicit visiting locations and the
+    // refresh of the cached weights
+    shared->trackCrowded(minCrowdedSeen);
+
+    nextMoveIsWait = false;
+    homeCoord = home;
+    targetPosition = home;
+    nextChange = 0.0;
+    stepTime = 0.0;
+}
+
+void SWIMHeadlessNode::step(double now)
+{
+    Coord lastPosition = targetPosition;
+    stepTime = now;
+
+    // a nodes switches between moving and waiting
+    if(nextMoveIsWait) {
+        nextChange = now + waitTime;
+
+    // or computes the next location to move to
+    } else {
+        targetPosition = nextTargetPosition(lastPosition);
+        nextChange = now + (targetPosition - lastPosition).length() / speed;
+    }
+
+    nextMoveIsWait = !nextMoveIsWait;
+}
+
+void SWIMHeadlessNode::restoreState(const swimNodeState &state, double time)
+{
+    targetPosition = state.target;
+    nextChange = state.endTime - time;
+    destLocId = state.locId;
+    nextMoveIsWait = state.waitNext;
+    firstStep = false;
+    stepTime = 0.0;
+
+    // the node counts are built up by the nodes heading to the locations
+    updateAllNodes(true);
+}
+
+SWIMTraceGenerator::SWIMTraceGenerator(const swimParams &params) : params(params), rng(params.seed)
+{
+    scheduled = 0;
+    preparedTime = -1.0;
+}
+
+bool SWIMTraceGenerator::setup(const std::vector<loc> *importedLocations, const std::vector<Coord> *homes)
+{
+    std::vector<loc> locs;
+    locHeader header;
+
+    // the given locations must be exactly the locations of the parameters
+    if(importedLocations != nullptr && importedLocations->size() != (size_t) params.noOfLocations) {
+        return false;
+    }
+
+    shared = std::make_shared<swimShared>();
+    nodes.clear();
+    wakeUps = std::priority_queue<wakeUp>();
+    scheduled = 0;
+    startSegments.clear();
+    preparedTime = -1.0;
+
+    // given homes replace the number of hosts (which still normalizes the weights)
+    int noOfNodes = (homes != nullptr ? (int) homes->size() : params.hosts);
+    nodes.resize(noOfNodes);
+
+    // the homes are spread uniformly over the area, as the default
+    // initialX and initialY of SWIMMobility do
+    for(int i = 0; i < noOfNodes; i++) {
+        Coord home;
+        if(homes != nullptr) {
+            home = (*homes)[i];
+        } else {
+            home.x = params.maxAreaX * rng.doubleRand();
+            home.y = params.maxAreaY * rng.doubleRand();
+            home.z = 0.0;
+        }
+        nodes[i].configure(params, shared, &rng, home);
+    }
+
+    // the locations are kept in memory only
+    if(importedLocations != nullptr) {
+        locs = *importedLocations;
+    } else if(noOfNodes > 0 && !nodes[0].createLocations(locs)) {
+        return false;
+    } else {
+        locs.resize(params.noOfLocations);
+    }
+
+    SWIMLocationsFile::initHeader(header);
+    header.noOfLocations = params.noOfLocations;
+    header.dimensions = params.dimensions;
+    header.maxAreaX = params.maxAreaX;
+    header.maxAreaY = params.maxAreaY;
+    header.maxAreaZ = params.maxAreaZ;
+    header.radius = params.radius;
+    header.seed = params.seed;
+    if(importedLocations == nullptr) {
+        header.layout = params.locationLayout.layout;
+        header.minSeparation = params.locationLayout.minSeparation;
+        if(header.layout == LAYOUT_THOMAS || header.layout == LAYOUT_MATERN) {
+            header.clusters = params.locationLayout.clusters;
+            header.clusterRadius = params.locationLayout.clusterRadius;
+        } else if(header.layout == LAYOUT_HEATMAP) {
+            header.heatmapHash = SWIMLocationGenerator::hashFile(params.locationLayout.heatmapFile.c_str());
+        }
+    } else {
+        header.layout = -1;
+    }
+    if(!shared->locationsFile.create(nullptr, header, locs)) {
+        return false;
+    }
+    shared->reset(params.noOfLocations, params.dimensions);
+
+    // every node takes its first step at the start, at its home
+    current.resize(noOfNodes);
+    startPositions.resize(noOfNodes);
+    for(int i = 0; i < noOfNodes; i++) {
+        wakeUps.push(wakeUp{0.0, scheduled++, i});
+        current[i].node = i;
+        current[i].locId = -1;
+        current[i].startTime = current[i].endTime = 0.0;
+        current[i].start = current[i].target = startPositions[i] = nodes[i].getHome();
+    }
+
+    return true;
+}
+
+bool SWIMTraceGenerator::restore(const SWIMSnapshot &snapshot)
+{
+    if(snapshot.states.size() != snapshot.homes.size() || snapshot.locations.size() != (size_t) params.noOfLocations
+            || !setup(&snapshot.locations, &snapshot.homes)) {
+        return false;
+    }
+
+    // the nodes wake up at the end of the segment they are in, of
+    // which the rest is handed out first (in the order of the nodes)
+    wakeUps = std::priority_queue<wakeUp>();
+    for(int i = (int) nodes.size() - 1; i >= 0; i--) {
+        const swimNodeState &state = snapshot.states[i];
+        nodes[i].restoreState(state, snapshot.time);
+        wakeUps.push(wakeUp{nodes[i].nextChange, scheduled++, i});
+
+        swimSegment segment;
+        segment.node = i;
+        segment.locId = state.locId;
+        segment.startTime = 0.0;
+        segment.endTime = nodes[i].nextChange;
+        segment.start = startPositions[i] = state.position;
+        segment.target = state.target;
+        startSegments.push_back(segment);
+    }
+
+    // the node counts of the nodes must be the saved ones
+    return snapshot.noOfNodesPresent == shared->noOfNodesPresent;
+}
+
+bool SWIMTraceGenerator::nextSegment(double until, swimSegment &segment)
+{
+    if(!startSegments.empty()) {
+        segment = current[startSegments.back().node] = startSegments.back();
+        startSegments.pop_back();
+        return true;
+    }
+
+    if(wakeUps.empty() || wakeUps.top().time > until) {
+        return false;
+    }
+
+    // the nodes waking up at the same time separate their locations
+    // at once, before any of them decides
+    if(params.threads > 1 && wakeUps.top().time != preparedTime) {
+        prepareWakeUps(wakeUps.top().time);
+    }
+
+    wakeUp next = wakeUps.top();
+    wakeUps.pop();
+
+    SWIMHeadlessNode &node = nodes[next.node];
+    segment.node = next.node;
+    segment.startTime = next.time;
+    segment.start = node.targetPosition;
+
+    node.step(next.time);
+
+    segment.endTime = node.nextChange;
+    segment.target = node.targetPosition;
+    segment.locId = node.getDestination();
+    current[next.node] = segment;
+
+    wakeUps.push(wakeUp{node.nextChange, scheduled++, next.node});
+    return true;
+}
+
+void SWIMTraceGenerator::prepareWakeUps(double time)
+{
+    std::vector<wakeUp> batch;
+    std::vector<SWIMModel *> preparing;
+
+    preparedTime = time;
+    while(!wakeUps.empty() && wakeUps.top().time == time) {
+        batch.push_back(wakeUps.top());
+        wakeUps.pop();
+    }
+    for(const wakeUp &next : batch) {
+        wakeUps.push(next);
+        if(nodes[next.node].needsLocations()) {
+            preparing.push_back(&nodes[next.node]);
+        }
+    }
+
+    SWIMModel::prepareLocationsOf(preparing, params.threads);
+}
+
+void SWIMTraceGenerator::runUntil(double time, std::vector<swimNodeState> &states)
+{
+    swimSegment segment;
+
+    while(nextSegment(time, segment)) {
+    }
+    getStates(time, states);
+}
+
+void SWIMTraceGenerator::getStates(double time, std::vector<swimNodeState> &states) const
+{
+    // the last segment of every node that starts up to the time is the
+    // one the node is in at that time
+    states.resize(nodes.size());
+    for(int i = 0; i < (int) nodes.size(); i++) {
+        const swimSegment &last = current[i];
+        swimNodeState &state = states[i];
+        state.target = last.target;
+        state.endTime = std::max(last.endTime, time);
+        state.locId = nodes[i].getDestination();
+        state.waitNext = nodes[i].isWaitNext();
+        if(last.endTime > last.startTime && last.endTime > time) {
+            state.position = last.start + (last.target - last.start) * ((time - last.startTime) / (last.endTime - last.startTime));
+        } else {
+            state.position = last.target;
+        }
+    }
+}
+
+void SWIMTraceGenerator::saveState(double time, SWIMSnapshot &snapshot) const
+{
+    snapshot.time = time;
+    snapshot.locations.assign(shared->locations, shared->locations + params.noOfLocations);
+    snapshot.noOfNodesPresent = shared->noOfNodesPresent;
+    snapshot.homes.resize(nodes.size());
+    for(int i = 0; i < (int) nodes.size(); i++) {
+        snapshot.homes[i] = nodes[i].getHome();
+    }
+    getStates(time, snapshot.states);
+}
+
+#ifdef SWIM_STATS
+bool SWIMTraceGenerator::writeStats(const std::string &prefix, double time)
+{
+    SWIMStats &stats = shared->stats;
+
+    stats.nodeNames.clear();
+    stats.nodeCounters.clear();
+    for(int i = 0; i < (int) nodes.size(); i++) {
+        stats.addNode("node " + std::to_string(i), nodes[i].getCounters());
+    }
+    stats.finishOccupancy(shared->noOfNodesPresent, time);
+
+    return stats.writeJson((prefix + ".json").c_str()) && stats.writeOccupancyCsv((prefix + "-occupancy.csv").c_str());
+}
+#endif
+
+}//namespace inet
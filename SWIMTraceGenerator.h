@@ -0,0 +1,232 @@
+/******************************************************************************
+ * SWIMMobility - A SWIM implementation for the INET Framework of the OMNeT++
+ * Simulator.
+ *
+ * Copyright (C) 2016, Sustainable Communication Networks, University of Bremen, Germany
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ *
+ ******************************************************************************/
+
+/**
+* The C++ include file of the headless SWIM trace generator. It runs the
+* SWIM model of a whole population without OMNeT++, driven by its own
+* queue of node wake-up times, and hands out the resulting movement as a
+* time ordered stream of segments (a move or a wait of one node).
+*
+* @author : Anas bin Muslim (anas1@uni-bremen.de)
+*
+*/
+
+#ifndef __INET_SWIMTRACEGENERATOR_H
+#define __INET_SWIMTRACEGENERATOR_H
+
+#include <stdint.h>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include "inet/mobility/single/SWIMModel.h"
+
+namespace inet {
+
+// parameters of a headless SWIM run (see SWIMMobility.ned)
+struct swimParams {
+    int hosts = 100;
+    int noOfLocations = 20;
+    int popularityDecisionThreshold = 7;
+    int returnHomePercentage = 15;
+    int dimensions = 2;
+
+    double neighbourLocationLimit = 300.0;
+    double radius = 5.0;
+    double alpha = 0.5;
+    double speed = 20.0;
+    double waitTime = 0.0;
+
+    double maxAreaX = 1000.0;
+    double maxAreaY = 1000.0;
+    double maxAreaZ = 0.0;
+
+    uint32_t seed = 0;
+    bool cacheLocationWeights = true;
+    bool weightedSelection = false;
+    bool fastDiscSampling = false;
+    bool batchedRandomNumbers = false;
+    bool implicitVisiting = false;
+
+    // threads to separate the locations of the nodes that wake up at
+    // the same time (1 to separate them one by one), which also create
+    // the locations in other layouts
+    int threads = 1;
+
+    // how the locations are created
+    swimLayoutParams locationLayout;
+};
+
+// one segment of the movement of a node: it moves from start (at
+// startTime) to target (at endTime), or waits when both are the same,
+// while heading to location locId (-1 for home)
+struct swimSegment {
+    int node;
+    int locId;
+    double startTime;
+    double endTime;
+    Coord start;
+    Coord target;
+};
+
+// Mersenne Twister with the same interpretation of the random numbers
+// as the default RNG of OMNeT++
+class INET_API SWIMHeadlessRng
+{
+protected:
+    std::mt19937 mt;
+
+public:
+    explicit SWIMHeadlessRng(uint32_t seed = 0) : mt(seed) {}
+
+    void seed(uint32_t seed) { mt.seed(seed); }
+
+    /** Returns a number in [0, 1) **/
+    double doubleRand() { return mt() * (1.0 / 4294967296.0); }
+
+    /** Returns count numbers in [0, 1), as doubleRand() does one by one **/
+    void doubleRands(double *numbers, int count) {
+        for(int i = 0; i < count; i++) {
+            numbers[i] = mt() * (1.0 / 4294967296.0);
+        }
+    }
+
+    /** Returns an integer in [0, n) **/
+    uint32_t intRand(uint32_t n);
+};
+
+class INET_API SWIMHeadlessNode : public SWIMModel
+{
+protected:
+    SWIMHeadlessRng *rng;
+    bool nextMoveIsWait;
+    double speed;
+    double waitTime;
+
+    // time of the current step
+    double stepTime;
+
+public:
+    Coord targetPosition;
+    double nextChange;
+
+protected:
+    virtual double drawUniform(double a, double b) override;
+
+    virtual int drawIntUniform(int a, int b) override;
+
+    virtual void drawUniformBlock(double *numbers, int count) override { rng->doubleRands(numbers, count); }
+
+#ifdef SWIM_STATS
+    virtual double statsTime() override { return stepTime; }
+#endif
+
+public:
+    /** Sets the parameters, the shared state and the home of the node **/
+    virtual void configure(const swimParams &params, std::shared_ptr<swimShared> shared, SWIMHeadlessRng *rng, const Coord &home);
+
+    /** Creates the random locations shared by all the nodes **/
+    virtual bool createLocations(std::vector<loc> &locs) { return generateLocations(locs); }
+
+    /** Takes the next step (a wait or a move) at the given time, as SWIMMobility::setTargetPosition() does **/
+    virtual void step(double now);
+
+    /** Continues from a saved state (at the given time, which becomes time 0) **/
+    virtual void restoreState(const swimNodeState &state, double time);
+
+    const Coord &getHome() const { return homeCoord; }
+    bool isWaitNext() const { return nextMoveIsWait; }
+
+    /** Whether the next step separates the locations, unless the node goes home **/
+    bool needsLocations() const { return !nextMoveIsWait && !locationsPrepared && !(cacheLocationWeights && weightsCached); }
+};
+
+class INET_API SWIMTraceGenerator
+{
+protected:
+    struct wakeUp {
+        double time;
+        uint64_t order;
+        int node;
+
+        // earliest first and, at the same time, in the order scheduled
+        bool operator<(const wakeUp &other) const {
+            return time > other.time || (time == other.time && order > other.order);
+        }
+    };
+
+    swimParams params;
+    SWIMHeadlessRng rng;
+    std::shared_ptr<swimShared> shared;
+    std::vector<SWIMHeadlessNode> nodes;
+
+    std::priority_queue<wakeUp> wakeUps;
+    uint64_t scheduled;
+
+    // the segment every node is in, where it starts and (when restored)
+    // the rest of the segments the nodes were in, which come first
+    std::vector<swimSegment> current;
+    std::vector<Coord> startPositions;
+    std::vector<swimSegment> startSegments;
+
+    // time of the last wake-ups whose locations were separated at once
+    double preparedTime;
+
+public:
+    /** Constructor **/
+    explicit SWIMTraceGenerator(const swimParams &params);
+
+    /** Creates the locations (or uses the given ones, as many as noOfLocations) and places every node at its home (random or given) **/
+    virtual bool setup(const std::vector<loc> *importedLocations = nullptr, const std::vector<Coord> *homes = nullptr);
+
+    /** Returns the next segment of the population that starts before (or at) the given time **/
+    virtual bool nextSegment(double until, swimSegment &segment);
+
+    /** Separates the locations of the nodes waking up at the given time on several threads **/
+    virtual void prepareWakeUps(double time);
+
+    /** Runs the population up to the given time and returns the state of every node at that time **/
+    virtual void runUntil(double time, std::vector<swimNodeState> &states);
+
+    /** Returns the state of every node at the given time, after the segments up to that time were taken **/
+    virtual void getStates(double time, std::vector<swimNodeState> &states) const;
+
+    /** Saves the locations and nodes at the given time, after the segments up to that time were taken **/
+    virtual void saveState(double time, SWIMSnapshot &snapshot) const;
+
+    /** Sets up the locations and nodes of a saved state instead of setup(), continuing from its time as time 0 **/
+    virtual bool restore(const SWIMSnapshot &snapshot);
+
+#ifdef SWIM_STATS
+    /** Writes the statistics of all nodes up to the given time (to <prefix>.json and <prefix>-occupancy.csv) **/
+    virtual bool writeStats(const std::string &prefix, double time);
+#endif
+
+    const swimParams &getParams() const { return params; }
+    const swimShared &getShared() const { return *shared; }
+    int getNoOfNodes() const { return nodes.size(); }
+    const SWIMHeadlessNode &getNode(int node) const { return nodes[node]; }
+    const Coord &getStartPosition(int node) const { return startPositions[node]; }
+};
+
+}//namespace inet
+
+#endif
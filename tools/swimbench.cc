@@ -0,0 +1,252 @@
+/******************************************************************************
+ * SWIMMobility - A SWIM implementation for the INET Framework of the OMNeT++
+ * Simulator.
+ *
+ * Copyright (C) 2016, Sustainable Communication Networks, University of Bremen, Germany
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ *
+ ******************************************************************************/
+
+/**
+ * Benchmarks of the SWIM model (Google Benchmark), run without OMNeT++.
+ * The functions called at every move of a node are measured one by one
+ * for a sweep of nodes (N) and locations (L), and a whole population is
+ * run to measure the moves (events) per second. See the README for how
+ * to build it and get the results as JSON.
+ *
+ * @author : Anas bin Muslim (anas1@uni-bremen.de)
+ *
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "inet/mobility/single/SWIMTraceGenerator.h"
+
+using namespace inet;
+
+// a node whose SWIM functions may be called one by one
+class SWIMBenchNode : public SWIMHeadlessNode
+{
+public:
+    using SWIMModel::seperateAndUpdateWeights;
+    using SWIMModel::decision;
+    using SWIMModel::chooseDestination;
+    using SWIMModel::updateNodesCount;
+    using SWIMModel::updateAllNodes;
+
+    void dropCachedWeights() { weightsCached = false; }
+    void setDestination(int locId) { destLocId = locId; }
+    std::vector<nodeProp> &getNeighbors() { return neighborLocs; }
+    int getPopularNeighbors() const { return popularNeighbors; }
+};
+
+// one node in a population of N nodes spread over L locations
+struct benchSetup {
+    swimParams params;
+    SWIMHeadlessRng rng;
+    std::shared_ptr<swimShared> shared;
+    SWIMBenchNode node;
+
+    benchSetup(int hosts, int locations, bool weighted = false, bool batched = false) : rng(1)
+    {
+        std::vector<loc> locs;
+        locHeader header;
+
+        params.hosts = hosts;
+        params.noOfLocations = locations;
+        params.weightedSelection = weighted;
+        params.fastDiscSampling = weighted;
+        params.batchedRandomNumbers = batched;
+        shared = std::make_shared<swimShared>();
+        node.configure(params, shared, &rng, Coord(params.maxAreaX / 2.0, params.maxAreaY / 2.0));
+        node.createLocations(locs);
+
+        SWIMLocationsFile::initHeader(header);
+        header.noOfLocations = locations;
+        shared->locationsFile.create(nullptr, header, locs);
+        shared->reset(locations, params.dimensions);
+
+        // the other nodes are at random locations
+        for(int i = 0; i < hosts - 1; i++) {
+            shared->noOfNodesPresent[rng.intRand(locations)]++;
+        }
+
+        node.seperateAndUpdateWeights();
+    }
+};
+
+static void sizeSweep(benchmark::internal::Benchmark *benchmark)
+{
+    benchmark->ArgNames({"N", "L"});
+    benchmark->ArgsProduct({{100, 1000, 10000}, {20, 200, 2000}});
+}
+
+// separation of all the locations and their weights
+static void BM_SeperateAndUpdateWeights(benchmark::State &state)
+{
+    benchSetup setup(state.range(0), state.range(1));
+    for(auto _ : state) {
+        setup.node.dropCachedWeights();
+        setup.node.seperateAndUpdateWeights();
+    }
+}
+BENCHMARK(BM_SeperateAndUpdateWeights)->Apply(sizeSweep);
+
+// update of the cached weights after another node moved
+static void BM_RefreshWeights(benchmark::State &state)
+{
+    benchSetup setup(state.range(0), state.range(1));
+    for(auto _ : state) {
+        int from = setup.rng.intRand(setup.params.noOfLocations);
+        int to = setup.rng.intRand(setup.params.noOfLocations);
+        setup.node.updateNodesCount(to, true);
+        setup.node.updateNodesCount(from, false);
+        setup.node.seperateAndUpdateWeights();
+    }
+}
+BENCHMARK(BM_RefreshWeights)->Apply(sizeSweep);
+
+static void BM_Decision(benchmark::State &state)
+{
+    benchSetup setup(state.range(0), state.range(1));
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(setup.node.decision());
+    }
+}
+BENCHMARK(BM_Decision)->Apply(sizeSweep);
+
+static void BM_ChooseDestination(benchmark::State &state)
+{
+    benchSetup setup(state.range(0), state.range(1));
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(setup.node.chooseDestination(setup.node.getNeighbors(), setup.node.getPopularNeighbors()));
+    }
+}
+BENCHMARK(BM_ChooseDestination)->Apply(sizeSweep);
+
+// weighted selection with rejection sampling around the location
+static void BM_ChooseDestinationWeighted(benchmark::State &state)
+{
+    benchSetup setup(state.range(0), state.range(1), true);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(setup.node.chooseDestination(setup.node.getNeighbors(), setup.node.getPopularNeighbors()));
+    }
+}
+BENCHMARK(BM_ChooseDestinationWeighted)->Apply(sizeSweep);
+
+// random numbers and positions around the location drawn in blocks
+static void BM_ChooseDestinationBatched(benchmark::State &state)
+{
+    benchSetup setup(state.range(0), state.range(1), false, true);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(setup.node.chooseDestination(setup.node.getNeighbors(), setup.node.getPopularNeighbors()));
+    }
+}
+BENCHMARK(BM_ChooseDestinationBatched)->Apply(sizeSweep);
+
+// weighted selection with the weights kept up to date
+static void BM_RefreshWeightsWeighted(benchmark::State &state)
+{
+    benchSetup setup(state.range(0), state.range(1), true);
+    for(auto _ : state) {
+        int from = setup.rng.intRand(setup.params.noOfLocations);
+        int to = setup.rng.intRand(setup.params.noOfLocations);
+        setup.node.updateNodesCount(to, true);
+        setup.node.updateNodesCount(from, false);
+        setup.node.seperateAndUpdateWeights();
+    }
+}
+BENCHMARK(BM_RefreshWeightsWeighted)->Apply(sizeSweep);
+
+static void BM_UpdateNodesCount(benchmark::State &state)
+{
+    benchSetup setup(state.range(0), state.range(1));
+    int locId = 0;
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(setup.node.updateNodesCount(locId, true));
+        benchmark::DoNotOptimize(setup.node.updateNodesCount(locId, false));
+        locId = (locId + 1) % setup.params.noOfLocations;
+    }
+    state.SetItemsProcessed(2 * state.iterations());
+}
+BENCHMARK(BM_UpdateNodesCount)->Apply(sizeSweep);
+
+static void BM_UpdateAllNodes(benchmark::State &state)
+{
+    benchSetup setup(state.range(0), state.range(1));
+    int locId = 0;
+    for(auto _ : state) {
+        setup.node.setDestination(locId);
+        setup.node.updateAllNodes(true);
+        setup.node.updateAllNodes(false);
+        locId = (locId + 1) % setup.params.noOfLocations;
+    }
+    state.SetItemsProcessed(2 * state.iterations());
+}
+BENCHMARK(BM_UpdateAllNodes)->Apply(sizeSweep);
+
+// a whole population, where every segment (move or wait) is one event
+static void endToEnd(benchmark::State &state, bool batched)
+{
+    swimParams params;
+    params.hosts = state.range(0);
+    params.noOfLocations = state.range(1);
+    params.waitTime = 30.0;
+    params.batchedRandomNumbers = batched;
+
+    SWIMTraceGenerator generator(params);
+    generator.setup();
+
+    // the first move of every node separates all the locations, which
+    // is left out of the measurement
+    swimSegment segment;
+    for(int i = 0; i < params.hosts; i++) {
+        generator.nextSegment(1e300, segment);
+    }
+
+    for(auto _ : state) {
+        if(!generator.nextSegment(1e300, segment)) {
+            state.SkipWithError("no more segments");
+            break;
+        }
+        benchmark::DoNotOptimize(segment);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_EndToEnd(benchmark::State &state)
+{
+    endToEnd(state, false);
+}
+
+static void BM_EndToEndBatched(benchmark::State &state)
+{
+    endToEnd(state, true);
+}
+
+// every node keeps its own list of all the locations, so the largest
+// population is left out to stay within a few hundred megabytes
+static void populationSizes(benchmark::internal::Benchmark *benchmark)
+{
+    benchmark->ArgNames({"N", "L"})
+            ->Args({100, 20})->Args({100, 200})->Args({100, 2000})
+            ->Args({1000, 20})->Args({1000, 200})->Args({1000, 2000})
+            ->Args({10000, 20})->Args({10000, 200})
+            ->Unit(benchmark::kMicrosecond);
+}
+BENCHMARK(BM_EndToEnd)->Apply(populationSizes);
+BENCHMARK(BM_EndToEndBatched)->Apply(populationSizes);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,383 @@
+/******************************************************************************
+ * SWIMMobility - A SWIM implementation for the INET Framework of the OMNeT++
+ * Simulator.
+ *
+ * Copyright (C) 2016, Sustainable Communication Networks, University of Bremen, Germany
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ *
+ ******************************************************************************/
+
+/**
+ * Command line tool that generates SWIM waypoint traces without OMNeT++,
+ * in BonnMotion or ns-2 format, or as a binary trace that SWIMMobility
+ * replays (replayTraceFile), or the contacts between the nodes in the
+ * connection event format of the ONE simulator. See the README for how to build it.
+ *
+ * @author : Anas bin Muslim (anas1@uni-bremen.de)
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "inet/mobility/single/SWIMContacts.h"
+
+using namespace inet;
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --hosts N                 number of nodes (100)\n"
+            "  --locations N             number of locations (20)\n"
+            "  --area X Y [Z]            maximum x, y (and z) of the area in meters (1000 1000 0)\n"
+            "  --dimensions 2|3          dimensions of the locations (2)\n"
+            "  --duration S              length of the trace in seconds (3600)\n"
+            "  --seed N                  seed of the random numbers (0)\n"
+            "  --alpha A                 alpha of the SWIM model (0.5)\n"
+            "  --threshold N             popularity decision threshold, 0-10 (7)\n"
+            "  --home-percentage N       percentage of moves returning home (15)\n"
+            "  --neighbour-limit M       radius of the neighbouring locations in meters (300)\n"
+            "  --radius M                radius around a location in meters (5)\n"
+            "  --speed V                 speed in meters per second (20)\n"
+            "  --wait S                  pause at every destination in seconds (0)\n"
+            "  --weighted                choose destinations in proportion to their weights\n"
+            "  --fast-disc               draw positions around a location by rejection sampling\n"
+            "  --batched-random          draw the random numbers of the decisions in blocks\n"
+            "  --implicit-visiting       keep no list of the visiting locations of a node\n"
+            "  --threads N               threads to separate the locations of nodes that\n"
+            "                            wake up at the same time (1)\n"
+            "  --import-locations FILE   take the locations from a text file (x y z per line)\n"
+            "  --layout L                uniform, thomas, matern or heatmap (uniform)\n"
+            "  --clusters N              clusters of the thomas and matern layouts (100)\n"
+            "  --cluster-radius M        standard deviation (thomas) or radius (matern)\n"
+            "                            of the clusters in meters (50)\n"
+            "  --min-separation M        minimum distance between two locations (0)\n"
+            "  --heatmap FILE            raster of cell weights (a row per line), for heatmap\n"
+            "  --format F                bonnmotion, ns2, swim (the binary trace replayed\n"
+            "                            by SWIMMobility) or contacts (bonnmotion)\n"
+            "  --range M                 range of a contact in meters, for contacts (10)\n"
+            "  --output FILE             write the trace to a file instead of stdout\n"
+            "                            (required for swim)\n"
+            "  --save-state FILE         save the nodes at the end of the trace to a state file\n"
+            "  --restore-state FILE      start from the nodes and locations of a state file\n"
+            "                            (not for swim)\n"
+            "  --stats PREFIX            write the statistics to PREFIX.json and\n"
+            "                            PREFIX-occupancy.csv (built with SWIM_STATS only)\n",
+            name);
+}
+
+// appends one formatted waypoint to the trace of a node
+static void appendWaypoint(std::string &trace, double time, const Coord &position, bool threeD)
+{
+    char buffer[96];
+    int length = threeD ? snprintf(buffer, sizeof(buffer), "%.6f %.3f %.3f %.3f ", time, position.x, position.y, position.z)
+                        : snprintf(buffer, sizeof(buffer), "%.6f %.3f %.3f ", time, position.x, position.y);
+    trace.append(buffer, length);
+}
+
+// writes the trace replayed by SWIMMobility
+static bool writeBinaryTrace(SWIMTraceGenerator &generator, double duration, const std::string &outputFile)
+{
+    SWIMTraceWriter writer;
+    std::vector<Coord> homes;
+    swimSegment segment;
+    bool written = true;
+
+    for(int i = 0; i < generator.getNoOfNodes(); i++) {
+        homes.push_back(generator.getNode(i).getHome());
+    }
+    if(!writer.open(outputFile.c_str(), homes, generator.getParams().noOfLocations)) {
+        fprintf(stderr, "Unable to open %s\n", outputFile.c_str());
+        return false;
+    }
+
+    while(written && generator.nextSegment(duration, segment)) {
+
+        // waits of no time need no segment
+        if(segment.endTime == segment.startTime && segment.start == segment.target) {
+            continue;
+        }
+
+        traceRecord record;
+        record.endTime = segment.endTime;
+        record.targetX = segment.target.x;
+        record.targetY = segment.target.y;
+        record.targetZ = segment.target.z;
+        record.locId = segment.locId;
+        written = writer.add(segment.node, record);
+    }
+
+    if(!writer.close() || !written) {
+        fprintf(stderr, "Unable to write %s\n", outputFile.c_str());
+        return false;
+    }
+    return true;
+}
+
+// saves the nodes at the end of the trace, if asked to
+static bool saveState(const SWIMTraceGenerator &generator, double duration, const std::string &saveFile)
+{
+    SWIMSnapshot snapshot;
+
+    if(saveFile.empty()) {
+        return true;
+    }
+    generator.saveState(duration, snapshot);
+    if(!snapshot.write(saveFile.c_str())) {
+        fprintf(stderr, "Unable to write the state file %s\n", saveFile.c_str());
+        return false;
+    }
+    return true;
+}
+
+// writes the statistics at the end of the trace, if asked to
+static bool writeStats(SWIMTraceGenerator &generator, double duration, const std::string &statsPrefix)
+{
+    if(statsPrefix.empty()) {
+        return true;
+    }
+#ifdef SWIM_STATS
+    if(!generator.writeStats(statsPrefix, duration)) {
+        fprintf(stderr, "Unable to write the statistics to %s.json\n", statsPrefix.c_str());
+        return false;
+    }
+    return true;
+#else
+    (void) generator;
+    (void) duration;
+    fprintf(stderr, "No statistics, as the tool was built without SWIM_STATS\n");
+    return false;
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+    swimParams params;
+    double duration = 3600.0;
+    double range = 10.0;
+    std::string format = "bonnmotion";
+    std::string outputFile;
+    std::string importFile;
+    std::string saveFile;
+    std::string restoreFile;
+    std::string statsPrefix;
+
+    // read the options
+    for(int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        bool hasValue = (i + 1 < argc);
+
+        if(option == "--help" || option == "-h") {
+            usage(argv[0]);
+            return 0;
+        } else if(option == "--hosts" && hasValue) {
+            params.hosts = atoi(argv[++i]);
+        } else if(option == "--locations" && hasValue) {
+            params.noOfLocations = atoi(argv[++i]);
+        } else if(option == "--area" && i + 2 < argc) {
+            params.maxAreaX = atof(argv[++i]);
+            params.maxAreaY = atof(argv[++i]);
+            if(i + 1 < argc && argv[i + 1][0] != '-') {
+                params.maxAreaZ = atof(argv[++i]);
+            }
+        } else if(option == "--dimensions" && hasValue) {
+            params.dimensions = atoi(argv[++i]);
+        } else if(option == "--duration" && hasValue) {
+            duration = atof(argv[++i]);
+        } else if(option == "--seed" && hasValue) {
+            params.seed = strtoul(argv[++i], nullptr, 10);
+        } else if(option == "--alpha" && hasValue) {
+            params.alpha = atof(argv[++i]);
+        } else if(option == "--threshold" && hasValue) {
+            params.popularityDecisionThreshold = atoi(argv[++i]);
+        } else if(option == "--home-percentage" && hasValue) {
+            params.returnHomePercentage = atoi(argv[++i]);
+        } else if(option == "--neighbour-limit" && hasValue) {
+            params.neighbourLocationLimit = atof(argv[++i]);
+        } else if(option == "--radius" && hasValue) {
+            params.radius = atof(argv[++i]);
+        } else if(option == "--speed" && hasValue) {
+            params.speed = atof(argv[++i]);
+        } else if(option == "--wait" && hasValue) {
+            params.waitTime = atof(argv[++i]);
+        } else if(option == "--weighted") {
+            params.weightedSelection = true;
+        } else if(option == "--fast-disc") {
+            params.fastDiscSampling = true;
+        } else if(option == "--batched-random") {
+            params.batchedRandomNumbers = true;
+        } else if(option == "--implicit-visiting") {
+            params.implicitVisiting = true;
+        } else if(option == "--threads" && hasValue) {
+            params.threads = atoi(argv[++i]);
+        } else if(option == "--import-locations" && hasValue) {
+            importFile = argv[++i];
+        } else if(option == "--layout" && hasValue) {
+            if(!SWIMLocationGenerator::parseLayout(argv[++i], params.locationLayout.layout)) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if(option == "--clusters" && hasValue) {
+            params.locationLayout.clusters = atoi(argv[++i]);
+        } else if(option == "--cluster-radius" && hasValue) {
+            params.locationLayout.clusterRadius = atof(argv[++i]);
+        } else if(option == "--min-separation" && hasValue) {
+            params.locationLayout.minSeparation = atof(argv[++i]);
+        } else if(option == "--heatmap" && hasValue) {
+            params.locationLayout.heatmapFile = argv[++i];
+        } else if(option == "--range" && hasValue) {
+            range = atof(argv[++i]);
+        } else if(option == "--format" && hasValue) {
+            format = argv[++i];
+        } else if(option == "--output" && hasValue) {
+            outputFile = argv[++i];
+        } else if(option == "--save-state" && hasValue) {
+            saveFile = argv[++i];
+        } else if(option == "--restore-state" && hasValue) {
+            restoreFile = argv[++i];
+        } else if(option == "--stats" && hasValue) {
+            statsPrefix = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if((format != "bonnmotion" && format != "ns2" && format != "swim" && format != "contacts")
+            || (format == "swim" && (outputFile.empty() || !restoreFile.empty())) || range <= 0.0
+            || params.hosts < 0 || params.noOfLocations < 0 || params.speed <= 0.0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // a saved state gives the nodes and the locations
+    SWIMSnapshot snapshot;
+    if(!restoreFile.empty()) {
+        if(!snapshot.read(restoreFile.c_str())) {
+            fprintf(stderr, "Unable to read the state file %s\n", restoreFile.c_str());
+            return 1;
+        }
+        params.hosts = snapshot.getNoOfNodes();
+        params.noOfLocations = snapshot.locations.size();
+    }
+
+    // create the locations and place the nodes at their homes
+    SWIMTraceGenerator generator(params);
+    std::vector<loc> importedLocations;
+    if(!importFile.empty() && !SWIMLocationsFile::readText(importFile.c_str(), params.noOfLocations, importedLocations)) {
+        fprintf(stderr, "Unable to import %d locations from %s\n", params.noOfLocations, importFile.c_str());
+        return 1;
+    }
+    if(!restoreFile.empty()) {
+        if(!generator.restore(snapshot)) {
+            fprintf(stderr, "Unable to restore the state file %s\n", restoreFile.c_str());
+            return 1;
+        }
+    } else if(!generator.setup(importFile.empty() ? nullptr : &importedLocations)) {
+        fprintf(stderr, "Unable to create the locations (area too small for the radius, heatmap unreadable or separation too large?)\n");
+        return 1;
+    }
+
+    // binary traces are written per node, in blocks
+    if(format == "swim") {
+        return writeBinaryTrace(generator, duration, outputFile) && saveState(generator, duration, saveFile)
+                && writeStats(generator, duration, statsPrefix) ? 0 : 1;
+    }
+
+    FILE *out = stdout;
+    if(!outputFile.empty() && (out = fopen(outputFile.c_str(), "w")) == nullptr) {
+        fprintf(stderr, "Unable to open %s\n", outputFile.c_str());
+        return 1;
+    }
+    static char outBuffer[1 << 20];
+    setvbuf(out, outBuffer, _IOFBF, sizeof(outBuffer));
+
+    bool threeD = (params.dimensions == 3);
+    swimSegment segment;
+    char line[160];
+
+    // ns-2 traces are written as the segments come (in time order)
+    if(format == "ns2") {
+        for(int i = 0; i < generator.getNoOfNodes(); i++) {
+            const Coord &start = generator.getStartPosition(i);
+            fprintf(out, "$node_(%d) set X_ %.3f\n$node_(%d) set Y_ %.3f\n$node_(%d) set Z_ %.3f\n",
+                    i, start.x, i, start.y, i, start.z);
+        }
+        while(generator.nextSegment(duration, segment)) {
+            if(segment.start != segment.target) {
+                int length = snprintf(line, sizeof(line), "$ns_ at %.6f \"$node_(%d) setdest %.3f %.3f %.3f\"\n",
+                        segment.startTime, segment.node, segment.target.x, segment.target.y, params.speed);
+                fwrite(line, 1, length, out);
+            }
+        }
+
+    // contacts are written as they become final (in time order)
+    } else if(format == "contacts") {
+        SWIMContactGenerator contacts(generator.getNoOfNodes(), range, params.maxAreaX, params.maxAreaY, duration);
+        swimContactEvent event;
+        bool done = false;
+
+        while(!done) {
+            if(generator.nextSegment(duration, segment)) {
+                contacts.addSegment(segment);
+            } else {
+                contacts.finish();
+                done = true;
+            }
+            while(contacts.nextEvent(event)) {
+                int length = snprintf(line, sizeof(line), "%.6f CONN %d %d %s\n",
+                        event.time, event.nodeA, event.nodeB, event.up ? "up" : "down");
+                fwrite(line, 1, length, out);
+            }
+        }
+
+    // BonnMotion traces hold one line of waypoints per node, so the
+    // waypoints are collected first
+    } else {
+        std::vector<std::string> traces(generator.getNoOfNodes());
+        std::vector<swimSegment> lastSegments(generator.getNoOfNodes());
+
+        while(generator.nextSegment(duration, segment)) {
+
+            // waits of no time add no waypoint
+            if(segment.endTime == segment.startTime && segment.start == segment.target) {
+                continue;
+            }
+            appendWaypoint(traces[segment.node], segment.startTime, segment.start, threeD);
+            lastSegments[segment.node] = segment;
+        }
+
+        // end every node at the position reached at the end of the trace
+        for(int i = 0; i < generator.getNoOfNodes(); i++) {
+            swimSegment &last = lastSegments[i];
+            Coord position = last.target;
+            if(last.endTime > duration) {
+                position = last.start + (last.target - last.start) * ((duration - last.startTime) / (last.endTime - last.startTime));
+            }
+            appendWaypoint(traces[i], duration, position, threeD);
+            traces[i].back() = '\n';
+            fwrite(traces[i].data(), 1, traces[i].size(), out);
+        }
+    }
+
+    if(out != stdout) {
+        fclose(out);
+    }
+    return saveState(generator, duration, saveFile) && writeStats(generator, duration, statsPrefix) ? 0 : 1;
+}